@@ -0,0 +1,1142 @@
+/*
+ * File: btree.c
+ *
+ * Name: Riley Heike
+ *
+ * Description: Program contains the same set methods as
+ * sorted.c, but keeps the elements in a B+tree instead of
+ * one sorted array, so adding or removing an element takes
+ * O(log n) rather than shifting the rest of the array.
+ * Every node is NODE_SIZE bytes, four cache lines, and is
+ * aligned to a cache line. The strings are packed into the
+ * nodes themselves: a node has an array of 2-byte offsets
+ * at the front, in sorted order, and the string bytes at
+ * the back, and an internal node also has a child pointer
+ * for each key. A string too long to share a node is kept
+ * in its own allocation and the node holds a pointer to it.
+ * Leaves hold the elements, and internal nodes hold the
+ * shortest prefixes that separate their children. A node
+ * is rewritten from a list of its entries whenever it
+ * changes, which is cheap since it is only a few cache
+ * lines long
+ *
+ */
+
+
+#include "set.h"
+#include "stats.h"
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#define NODE_SIZE 256
+#define DATA_SIZE ((int) (NODE_SIZE - sizeof(struct node *) - 2 * sizeof(unsigned short)))
+#define INLINE_MAX 48
+#define OUTLINE 0x8000
+#define MAX_ENTRIES (2 * DATA_SIZE / 3 + 2)
+
+#define MAX_DEPTH 64
+
+#define MISSING 0
+#define DONE 1
+#define SPLIT 2
+#define UNDER 3
+
+#define ADD 1
+#define REMOVE 2
+#define TOGGLE (ADD | REMOVE)
+
+#ifdef SETSTATS
+#define COUNT(x) ((x)++)
+#define RECORD(h, n) ((h)[statBucket(n)]++)
+#else
+#define COUNT(x) ((void) 0)
+#define RECORD(h, n) ((void) 0)
+#endif
+
+/* A node is a leaf if first is NULL. Otherwise first is
+ * the child holding the keys less than every key in the
+ * node, and each key's child holds the keys from that key
+ * up to the next one */
+
+struct node{
+
+	struct node *first;
+	unsigned short count;
+	unsigned short top;
+	char data[DATA_SIZE];
+
+};
+
+struct entry{
+
+	char *key;
+	int len;
+	bool outline;
+	struct node *child;
+
+};
+
+struct split{
+
+	struct entry sep;
+	char buf[INLINE_MAX];
+
+};
+
+/* An iterator keeps the path from the root to the leaf it
+ * is in. At each level, index is the next key of a leaf or
+ * the next child of an internal node to visit */
+
+struct setiter{
+
+	SET *sp;
+	int depth;
+	struct node *path[MAX_DEPTH];
+	int index[MAX_DEPTH];
+
+};
+
+struct set {
+
+	struct node *root;
+	int count;
+	int nodes;
+	struct setiter iter;
+#ifdef SETSTATS
+	struct setstats stats;
+#endif
+
+};
+
+
+/* Offsets
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns the array of key offsets in a node,
+ * which follows the child pointers in an internal node
+ *
+ */
+
+static unsigned short *offsets(struct node *np){
+
+	return (unsigned short *) (np->data +
+		(np->first ? sizeof(struct node *) * np->count : 0));
+
+}
+
+/* Key
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns key i of a node, and sets outline
+ * to whether it is kept in its own allocation
+ *
+ */
+
+static char *key(struct node *np, int i, bool *outline){
+
+	unsigned short off = offsets(np)[i];
+	char *s;
+
+	*outline = off & OUTLINE;
+	if(!*outline) return np->data + off;
+
+	memcpy(&s, np->data + (off & ~OUTLINE), sizeof(char *));
+	return s;
+
+}
+
+/* Child
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns the child of key i of an internal
+ * node, or the first child if i is -1
+ *
+ */
+
+static struct node *child(struct node *np, int i){
+
+	struct node *cp;
+
+	if(i < 0) return np->first;
+	memcpy(&cp, np->data + sizeof(struct node *) * i, sizeof(struct node *));
+	return cp;
+
+}
+
+/* Used
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns the number of data bytes a node is
+ * using for its keys, offsets and child pointers
+ *
+ */
+
+static int used(struct node *np){
+
+	int slot = sizeof(unsigned short) + (np->first ? sizeof(struct node *) : 0);
+	return DATA_SIZE - np->top + slot * np->count;
+
+}
+
+/* Width
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns the number of data bytes an entry
+ * takes up in a leaf or an internal node
+ *
+ */
+
+static int width(struct entry *ep, bool leaf){
+
+	return ep->len + sizeof(unsigned short) + (leaf ? 0 : sizeof(struct node *));
+
+}
+
+/* Locate
+ *
+ * Complexity: O(log n)
+ *
+ * Description: Performs binary search over the keys of a
+ * node and returns how many of them are less than or equal
+ * to elt, modifys boolean found to determine if one of them
+ * matched. In an internal node, elt belongs under the child
+ * of the key before the returned index
+ *
+ */
+
+static int locate(SET *sp, struct node *np, char *elt, bool *found){
+
+	int hi = np->count-1;
+	int low = 0;
+	int comp;
+	int mid;
+	bool outline;
+
+	(void) sp;
+	*found = false;
+	while(low<=hi){
+
+		mid = (hi+low)/2;
+		comp = strcmp(key(np, mid, &outline), elt);
+		COUNT(sp->stats.compares);
+
+		if(comp == 0){
+
+			*found = true;
+			return mid+1;
+
+		}
+
+		else if(comp > 0)hi = mid-1;
+
+		else low  = mid+1;
+
+	}
+
+	return low;
+
+}
+
+/* Gather
+ *
+ * Complexity: O(n)
+ *
+ * Description: Fills in an entry for each key of a node in
+ * order and returns how many there are. The entries point
+ * into the node, so it must not change while they are used
+ *
+ */
+
+static int gather(struct node *np, struct entry *e){
+
+	int i;
+	for(i = 0; i < np->count; i++){
+
+		e[i].key = key(np, i, &e[i].outline);
+		e[i].len = e[i].outline ? sizeof(char *) : strlen(e[i].key) + 1;
+		e[i].child = np->first ? child(np, i) : NULL;
+
+	}
+
+	return np->count;
+
+}
+
+/* Fill
+ *
+ * Complexity: O(n)
+ *
+ * Description: Rewrites a node to hold the n entries in
+ * order, with first as its first child or NULL for a leaf.
+ * The entries must not point into the node itself
+ *
+ */
+
+static void fill(struct node *np, struct node *first, struct entry *e, int n){
+
+	unsigned short *offs;
+
+	np->first = first;
+	np->count = n;
+	np->top = DATA_SIZE;
+	offs = offsets(np);
+
+	int i;
+	for(i = 0; i < n; i++){
+
+		np->top -= e[i].len;
+
+		if(e[i].outline){
+			memcpy(np->data + np->top, &e[i].key, sizeof(char *));
+			offs[i] = np->top | OUTLINE;
+		}
+
+		else{
+			memcpy(np->data + np->top, e[i].key, e[i].len);
+			offs[i] = np->top;
+		}
+
+		if(first) memcpy(np->data + sizeof(struct node *) * i, &e[i].child,
+			sizeof(struct node *));
+
+	}
+
+	assert(used(np) <= DATA_SIZE);
+
+}
+
+/* Create Node
+ *
+ * Complexity: O(1)
+ *
+ * Description: Allocates an empty leaf aligned to a cache
+ * line
+ *
+ */
+
+static struct node *createNode(SET *sp){
+
+	struct node *np = aligned_alloc(64, sizeof(struct node));
+	assert(np);
+	np->first = NULL;
+	np->count = 0;
+	np->top = DATA_SIZE;
+	sp->nodes++;
+	return np;
+
+}
+
+/* Separate
+ *
+ * Complexity: O(n) (for string length n)
+ *
+ * Description: Sets up the separator between two leaves
+ * whose keys end with low and start with high, which is the
+ * shortest prefix of high that is greater than low
+ *
+ */
+
+static void separate(char *low, char *high, struct split *up){
+
+	int n = 0;
+	while(low[n] == high[n]) n++;
+	n++;
+
+	up->sep.outline = n + 1 > INLINE_MAX;
+
+	if(up->sep.outline){
+		up->sep.key = strndup(high, n);
+		assert(up->sep.key);
+		up->sep.len = sizeof(char *);
+	}
+
+	else{
+		memcpy(up->buf, high, n);
+		up->buf[n] = '\0';
+		up->sep.key = up->buf;
+		up->sep.len = n + 1;
+	}
+
+}
+
+/* Store
+ *
+ * Complexity: O(n)
+ *
+ * Description: Writes the n entries into a node. If they do
+ * not fit, the upper part goes into right, which is created
+ * if it is NULL, and the key that separates the two nodes
+ * is returned in up along with right. Returns true if the
+ * entries were split
+ *
+ */
+
+static bool store(SET *sp, struct node *np, struct node *right, struct node *first,
+	struct entry *e, int n, struct split *up){
+
+	bool leaf = first == NULL;
+	int total = 0, left = 0;
+
+	int i;
+	for(i = 0; i < n; i++) total += width(&e[i], leaf);
+
+	if(total <= DATA_SIZE){
+		fill(np, first, e, n);
+		return false;
+	}
+
+	int k = 0;
+	while(k < n - (leaf ? 1 : 2) && left + width(&e[k], leaf) <= total/2){
+		left += width(&e[k], leaf);
+		k++;
+	}
+	if(k == 0) k = 1;
+
+	if(right == NULL) right = createNode(sp);
+
+	if(leaf){
+
+		fill(right, NULL, e + k, n - k);
+		fill(np, NULL, e, k);
+		separate(e[k-1].key, e[k].key, up);
+
+	}
+
+	else{
+
+		up->sep = e[k];
+		if(!e[k].outline){
+			memcpy(up->buf, e[k].key, e[k].len);
+			up->sep.key = up->buf;
+		}
+
+		fill(right, e[k].child, e + k + 1, n - k - 1);
+		fill(np, first, e, k);
+
+	}
+
+	up->sep.child = right;
+	return true;
+
+}
+
+/* Fix
+ *
+ * Complexity: O(1)
+ *
+ * Description: Repairs child c of a node, given by the n
+ * entries of the node and its first child, after the child
+ * fell below a quarter full. The child and a neighbor are
+ * merged into one node if they fit, and otherwise their
+ * keys are shared out evenly and the separator between
+ * them replaced, using tmp to hold it. Returns the new
+ * number of entries
+ *
+ */
+
+static int fix(SET *sp, struct node *first, struct entry *e, int n, int c,
+	struct split *tmp){
+
+	if(n == 0) return n;
+
+	int s = c + 1 < n ? c + 1 : c;
+	struct node *lp = s == 0 ? first : e[s-1].child;
+	struct node *rp = e[s].child;
+	struct node lsnap = *lp, rsnap = *rp;
+	struct entry m[MAX_ENTRIES];
+
+	int k = gather(&lsnap, m);
+
+	if(lsnap.first){
+		m[k] = e[s];
+		m[k++].child = rsnap.first;
+	}
+
+	else if(e[s].outline) free(e[s].key);
+
+	k += gather(&rsnap, m + k);
+
+	if(store(sp, lp, rp, lsnap.first, m, k, tmp)){
+		e[s] = tmp->sep;
+		return n;
+	}
+
+	free(rp);
+	sp->nodes--;
+	memmove(e + s, e + s + 1, sizeof(struct entry) * (n - s - 1));
+	return n - 1;
+
+}
+
+/* Change
+ *
+ * Complexity: O(log n)
+ *
+ * Description: Adds elt to or removes it from the subtree
+ * rooted at a node, in one pass down the tree. Mode says
+ * what may be done at the leaf: ADD adds elt if it is not
+ * there, REMOVE removes it if it is, and TOGGLE does
+ * whichever applies. Found is set to whether elt was in the
+ * set, and copy to the set's copy of elt afterwards, which
+ * stays put until the leaf next changes. Returns MISSING if
+ * nothing was changed, UNDER if the node is now less than
+ * a quarter full, SPLIT if the node had to be split, with
+ * the separator and new node in up, and DONE otherwise
+ *
+ */
+
+static int change(SET *sp, struct node *np, char *elt, int mode, struct split *up,
+	bool *found, char **copy){
+
+	struct node snap;
+	struct entry e[MAX_ENTRIES];
+	struct split down;
+	bool outline;
+	int n, r;
+
+	int i = locate(sp, np, elt, found);
+
+	if(np->first == NULL){
+
+		if(!(mode & (*found ? REMOVE : ADD))){
+			*copy = *found ? key(np, i-1, &outline) : NULL;
+			return MISSING;
+		}
+
+		snap = *np;
+		n = gather(&snap, e);
+
+		if(*found){
+			if(e[i-1].outline) free(e[i-1].key);
+			memmove(e + i - 1, e + i, sizeof(struct entry) * (n - i));
+			fill(np, NULL, e, n - 1);
+			*copy = NULL;
+			return used(np) < DATA_SIZE / 4 ? UNDER : DONE;
+		}
+
+		memmove(e + i + 1, e + i, sizeof(struct entry) * (n - i));
+
+		e[i].len = strlen(elt) + 1;
+		e[i].outline = e[i].len > INLINE_MAX;
+		e[i].child = NULL;
+		e[i].key = elt;
+
+		if(e[i].outline){
+			e[i].key = strdup(elt);
+			assert(e[i].key);
+			e[i].len = sizeof(char *);
+		}
+
+		r = store(sp, np, NULL, NULL, e, n+1, up) ? SPLIT : DONE;
+		*copy = i < np->count ? key(np, i, &outline) :
+			key(up->sep.child, i - np->count, &outline);
+		return r;
+
+	}
+
+	r = change(sp, child(np, i-1), elt, mode, &down, found, copy);
+	if(r == MISSING || r == DONE) return r;
+
+	snap = *np;
+	n = gather(&snap, e);
+
+	if(r == SPLIT){
+		memmove(e + i + 1, e + i, sizeof(struct entry) * (n - i));
+		e[i] = down.sep;
+		n++;
+	}
+
+	else n = fix(sp, snap.first, e, n, i-1, &down);
+
+	if(store(sp, np, NULL, snap.first, e, n, up)) return SPLIT;
+	return used(np) < DATA_SIZE / 4 ? UNDER : DONE;
+
+}
+
+/* Apply
+ *
+ * Complexity: O(log n)
+ *
+ * Description: Changes the tree as in change, starting at
+ * the root. If the root splits, a new root is made above
+ * it, so the tree only grows in height at the top, and if
+ * the root is left with a single child, that child becomes
+ * the root. Returns whether elt was in the set
+ *
+ */
+
+static bool apply(SET *sp, char *elt, int mode, char **copy){
+
+	struct split up;
+	struct node *np;
+	bool found;
+#ifdef SETSTATS
+	long before = sp->stats.compares;
+#endif
+
+	int r = change(sp, sp->root, elt, mode, &up, &found, copy);
+	RECORD(sp->stats.probes, sp->stats.compares - before);
+	if(r == MISSING) return found;
+
+	sp->count += found ? -1 : 1;
+
+	if(r == SPLIT){
+		np = createNode(sp);
+		fill(np, sp->root, &up.sep, 1);
+		sp->root = np;
+	}
+
+	if(sp->root->first && sp->root->count == 0){
+		np = sp->root;
+		sp->root = np->first;
+		free(np);
+		sp->nodes--;
+	}
+
+	return found;
+
+}
+
+/* Release
+ *
+ * Complexity: O(n)
+ *
+ * Description: Frees a subtree along with any keys kept
+ * in their own allocations
+ *
+ */
+
+static void release(struct node *np){
+
+	bool outline;
+	char *s;
+
+	int i;
+	for(i = 0; i < np->count; i++){
+
+		s = key(np, i, &outline);
+		if(outline) free(s);
+		if(np->first) release(child(np, i));
+
+	}
+
+	if(np->first) release(np->first);
+	free(np);
+
+}
+
+/* Collect
+ *
+ * Complexity: O(n)
+ *
+ * Description: Appends the elements in a subtree to elts
+ * in order, starting at index *n
+ *
+ */
+
+static void collect(struct node *np, char **elts, int *n){
+
+	bool outline;
+
+	int i;
+	if(np->first){
+
+		collect(np->first, elts, n);
+		for(i = 0; i < np->count; i++) collect(child(np, i), elts, n);
+
+	}
+
+	else for(i = 0; i < np->count; i++) elts[(*n)++] = key(np, i, &outline);
+
+}
+
+
+/* Visit
+ *
+ * Complexity: O(n)
+ *
+ * Description: Calls fn with each element in a subtree in
+ * order, along with ctx
+ *
+ */
+
+static void visit(struct node *np, void (*fn)(), void *ctx){
+
+	bool outline;
+
+	int i;
+	if(np->first){
+
+		visit(np->first, fn, ctx);
+		for(i = 0; i < np->count; i++) visit(child(np, i), fn, ctx);
+
+	}
+
+	else for(i = 0; i < np->count; i++) (*fn)(key(np, i, &outline), ctx);
+
+}
+
+/* Descend
+ *
+ * Complexity: O(log n)
+ *
+ * Description: Pushes the path from a node down to its
+ * leftmost leaf onto an iterator
+ *
+ */
+
+static void descend(SETITER *it, struct node *np){
+
+	while(1){
+
+		assert(it->depth < MAX_DEPTH);
+		it->path[it->depth] = np;
+		it->index[it->depth++] = 0;
+
+		if(!np->first) break;
+		np = np->first;
+
+	}
+
+}
+
+
+/* Create Set
+ *
+ * Complexity: O(1)
+ *
+ * Description: Allocates memory and creates set based
+ * on set struct, returns pointer to set. The tree grows
+ * as needed, so maxElts is not used
+ *
+ */
+
+SET *createSet(int maxElts){
+
+	SET *sp;
+	(void) maxElts;
+	sp = malloc(sizeof(SET));
+	assert(sp);
+	sp->count = 0;
+	sp->nodes = 0;
+	sp->root = createNode(sp);
+	sp->iter.sp = sp;
+#ifdef SETSTATS
+	memset(&sp->stats, 0, sizeof(struct setstats));
+#endif
+
+	return sp;
+
+}
+
+/* Destroy Set
+ *
+ * Complexity: O(n)
+ *
+ * Description: Frees every node and string in the set
+ *
+ */
+
+void destroySet(SET *sp){
+
+	assert(sp);
+	release(sp->root);
+	free(sp);
+
+}
+
+/* Number Elements
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns number of elements in set
+ *
+ */
+
+int numElements(SET *sp){
+
+	return sp->count;
+
+}
+
+/* Add Element
+ *
+ * Complexity: O(log n)
+ *
+ * Description: Adds a copy of elt to the tree if it is not
+ * already there
+ *
+ */
+
+void addElement(SET *sp, char *elt){
+
+	assert(sp && elt);
+	char *copy;
+	apply(sp, elt, ADD, &copy);
+
+}
+
+/* Remove Element
+ *
+ * Complexity: O(log n)
+ *
+ * Description: Removes elt from the tree if it is there,
+ * merging or sharing out nodes that fall below a quarter
+ * full
+ *
+ */
+
+void removeElement(SET *sp, char *elt){
+
+	assert(sp && elt);
+	char *copy;
+	apply(sp, elt, REMOVE, &copy);
+
+}
+
+/* Find Or Add Element
+ *
+ * Complexity: O(log n)
+ *
+ * Description: Adds a copy of elt to the tree if it is not
+ * already there, in the same pass down the tree that finds
+ * it, and returns the copy in the set
+ *
+ */
+
+char *findOrAddElement(SET *sp, char *elt, bool *inserted){
+
+	assert(sp && elt);
+	char *copy;
+	bool found = apply(sp, elt, ADD, &copy);
+
+	if(inserted) *inserted = !found;
+	return copy;
+
+}
+
+/* Toggle Element
+ *
+ * Complexity: O(log n)
+ *
+ * Description: Removes elt from the tree if it is there and
+ * adds it if not, in one pass down the tree, and returns
+ * whether it is now in the set
+ *
+ */
+
+bool toggleElement(SET *sp, char *elt){
+
+	assert(sp && elt);
+	char *copy;
+	return !apply(sp, elt, TOGGLE, &copy);
+
+}
+
+/* Find Element
+ *
+ * Complexity: O(log n)
+ *
+ * Description: Follows the separators down to the leaf
+ * that would hold elt, returns element if found and NULL
+ * if not found
+ *
+ */
+
+char *findElement(SET *sp, char *elt){
+
+	assert(sp && elt);
+	struct node *np = sp->root;
+	bool found;
+	int i;
+#ifdef SETSTATS
+	long before = sp->stats.compares;
+#endif
+
+	while(1){
+
+		i = locate(sp, np, elt, &found);
+
+		if(np->first == NULL){
+			RECORD(sp->stats.probes, sp->stats.compares - before);
+			return found ? elt : NULL;
+		}
+
+		np = child(np, i-1);
+
+	}
+
+}
+
+/* Get Elements
+ *
+ * Complexity: O(n)
+ *
+ * Description: Returns an array of the elements in sorted
+ * order. The strings belong to the set and may move when
+ * it is next changed
+ *
+ */
+
+char **getElements(SET *sp){
+
+	assert(sp);
+	char **elts = malloc(sizeof(char*) * (sp->count ? sp->count : 1));
+	assert(elts);
+
+	int n = 0;
+	collect(sp->root, elts, &n);
+	return elts;
+
+}
+
+
+/* Begin Set
+ *
+ * Complexity: O(log n)
+ *
+ * Description: Starts the set's iterator over at the
+ * first element and returns it
+ *
+ */
+
+SETITER *beginSet(SET *sp){
+
+	assert(sp);
+	sp->iter.depth = 0;
+	descend(&sp->iter, sp->root);
+	return &sp->iter;
+
+}
+
+
+/* Next Element
+ *
+ * Complexity: O(1) amortized, O(log n) worst case
+ *
+ * Description: Returns the next element of the walk, in
+ * sorted order, or NULL once every element has been
+ * returned. A finished node is popped, and the next child
+ * of its parent is descended into
+ *
+ */
+
+char *nextElement(SETITER *it){
+
+	assert(it);
+	struct node *np;
+	bool outline;
+
+	while(it->depth > 0){
+
+		np = it->path[it->depth-1];
+
+		if(it->index[it->depth-1] == np->count) it->depth--;
+
+		else if(!np->first) return key(np, it->index[it->depth-1]++, &outline);
+
+		else descend(it, child(np, it->index[it->depth-1]++));
+
+	}
+
+	return NULL;
+
+}
+
+
+/* For Each Element
+ *
+ * Complexity: O(n)
+ *
+ * Description: Calls fn with each element, in sorted
+ * order, and ctx
+ *
+ */
+
+void forEachElement(SET *sp, void (*fn)(), void *ctx){
+
+	assert(sp && fn);
+	visit(sp->root, fn, ctx);
+
+}
+
+
+/* Tally
+ *
+ * Complexity: O(n)
+ *
+ * Description: Adds the strings kept in their own
+ * allocations in a subtree to bytes, and the number of
+ * keys in each leaf to the histogram of chains
+ *
+ */
+
+static void tally(struct node *np, struct setstats *stats){
+
+	bool outline;
+	char *s;
+
+	int i;
+	for(i = 0; i < np->count; i++){
+
+		s = key(np, i, &outline);
+		if(outline) stats->bytes += strlen(s) + 1;
+		if(np->first) tally(child(np, i), stats);
+
+	}
+
+	if(np->first) tally(np->first, stats);
+	else stats->chains[statBucket(np->count)]++;
+
+}
+
+/* Replace
+ *
+ * Complexity: O(n)
+ *
+ * Description: Frees the tree of sp and gives it the tree
+ * of np instead, then frees np. Used to change a set in
+ * place by building the result separately, since the keys
+ * of a tree may move whenever it is changed
+ *
+ */
+
+static SET *replace(SET *sp, SET *np){
+
+	release(sp->root);
+	sp->root = np->root;
+	sp->count = np->count;
+	sp->nodes = np->nodes;
+	free(np);
+	return sp;
+
+}
+
+
+/* Union Sets
+ *
+ * Complexity: O((n + m) log(n + m))
+ *
+ * Description: Adds each element of sp2 to sp1, or to a
+ * new set that starts with sp1's elements
+ *
+ */
+
+SET *unionSets(SET *sp1, SET *sp2, bool inPlace){
+
+	assert(sp1 && sp2 && sp1 != sp2);
+	SET *dst = sp1;
+	SETITER *it;
+	char *elt;
+
+	if(!inPlace){
+		dst = createSet(0);
+		for(it = beginSet(sp1); (elt = nextElement(it)) != NULL; ) addElement(dst, elt);
+	}
+
+	for(it = beginSet(sp2); (elt = nextElement(it)) != NULL; ) addElement(dst, elt);
+	return dst;
+
+}
+
+
+/* Intersect Sets
+ *
+ * Complexity: O(min(n, m) log(n + m)), or O(n log m) in place
+ *
+ * Description: Returns the elements of sp1 that are also
+ * in sp2. A new set walks the smaller set and searches the
+ * other. In place, the elements kept are gathered into a
+ * new tree that replaces sp1's
+ *
+ */
+
+SET *intersectSets(SET *sp1, SET *sp2, bool inPlace){
+
+	assert(sp1 && sp2 && sp1 != sp2);
+	SET *dst = createSet(0), *small = sp1, *large = sp2;
+	SETITER *it;
+	char *elt;
+
+	if(!inPlace && sp2->count < sp1->count){
+		small = sp2;
+		large = sp1;
+	}
+
+	for(it = beginSet(small); (elt = nextElement(it)) != NULL; )
+		if(findElement(large, elt) != NULL) addElement(dst, elt);
+
+	return inPlace ? replace(sp1, dst) : dst;
+
+}
+
+
+/* Difference Sets
+ *
+ * Complexity: O(n log(n + m)), or O(m log n) in place
+ * if sp2 is smaller
+ *
+ * Description: Returns the elements of sp1 that are not
+ * in sp2. In place, each element of sp2 is removed from
+ * sp1 if sp2 is the smaller set, and otherwise the elements
+ * kept are gathered into a new tree as for intersectSets
+ *
+ */
+
+SET *differenceSets(SET *sp1, SET *sp2, bool inPlace){
+
+	assert(sp1 && sp2 && sp1 != sp2);
+	SET *dst;
+	SETITER *it;
+	char *elt;
+
+	if(inPlace && sp2->count < sp1->count){
+		for(it = beginSet(sp2); (elt = nextElement(it)) != NULL; ) removeElement(sp1, elt);
+		return sp1;
+	}
+
+	dst = createSet(0);
+	for(it = beginSet(sp1); (elt = nextElement(it)) != NULL; )
+		if(findElement(sp2, elt) == NULL) addElement(dst, elt);
+
+	return inPlace ? replace(sp1, dst) : dst;
+
+}
+
+
+/* Get Set Stats
+ *
+ * Complexity: O(n)
+ *
+ * Description: Fills in stats for the set. The length is
+ * the number of nodes, each chain is a leaf, and a probe
+ * is a string compare made by one search down the tree
+ *
+ */
+
+void getSetStats(SET *sp, struct setstats *stats){
+
+	assert(sp && stats);
+	memset(stats, 0, sizeof(struct setstats));
+	stats->count = sp->count;
+	stats->length = sp->nodes;
+	stats->bytes = sizeof(SET) + sizeof(struct node) * sp->nodes;
+	tally(sp->root, stats);
+
+#ifdef SETSTATS
+	stats->compares = sp->stats.compares;
+	stats->hashes = sp->stats.hashes;
+	memcpy(stats->probes, sp->stats.probes, sizeof(stats->probes));
+#else
+	stats->compares = -1;
+	stats->hashes = -1;
+#endif
+
+}
@@ -11,8 +11,35 @@
 # ifndef SET_H
 # define SET_H
 
+# include <stddef.h>
+# include <stdbool.h>
+
 typedef struct set SET;
 
+typedef struct setiter SETITER;
+
+/*
+ * Statistics about a set.  A histogram counts lengths by powers of two:
+ * bucket 0 counts lengths of zero and bucket k counts lengths from
+ * 2^(k-1) to 2^k - 1.  The compare and hash counts and the histogram of
+ * probes are only kept if the set is compiled with -DSETSTATS; otherwise
+ * the counts are -1 and the histogram is empty, and the set does no extra
+ * work.  The other fields are worked out when the statistics are asked for.
+ */
+
+# define STAT_BUCKETS 32
+
+struct setstats {
+    int count;                  /* number of elements                  */
+    int length;                 /* number of slots or buckets          */
+    int tombstones;             /* deleted slots not yet reused        */
+    size_t bytes;               /* bytes allocated by the set          */
+    long compares;              /* calls to the compare function       */
+    long hashes;                /* calls to the hash function          */
+    long probes[STAT_BUCKETS];  /* searches by elements examined       */
+    long chains[STAT_BUCKETS];  /* filled runs or chains by length     */
+};
+
 SET *createSet(int maxElts);
 
 void destroySet(SET *sp);
@@ -27,4 +54,43 @@ char *findElement(SET *sp, char *elt);
 
 char **getElements(SET *sp);
 
+/*
+ * findOrAddElement returns the copy of ELT in the set, adding one if there
+ * was none, and sets *INSERTED, if given, to whether it was added.
+ * toggleElement adds ELT if it is missing and removes it if it is there,
+ * returning whether it is now in the set.  Each looks for ELT only once.
+ */
+
+char *findOrAddElement(SET *sp, char *elt, bool *inserted);
+
+bool toggleElement(SET *sp, char *elt);
+
+void getSetStats(SET *sp, struct setstats *stats);
+
+/*
+ * An iterator walks the elements of a set where they are stored, so that
+ * they can be visited without copying them into an array.  Each set has
+ * a single iterator, and beginSet starts it over, so only one walk of a
+ * set can be under way at once.  The set must not be changed during a
+ * walk.  forEachElement calls FN with each element and CTX in turn.
+ */
+
+SETITER *beginSet(SET *sp);
+
+char *nextElement(SETITER *it);
+
+void forEachElement(SET *sp, void (*fn)(), void *ctx);
+
+/*
+ * The set operations return SP1 changed to hold the result if INPLACE is
+ * true, and otherwise a new set holding copies of the strings, which the
+ * caller destroys.  SP2 is never changed.  The two sets must differ.
+ */
+
+SET *unionSets(SET *sp1, SET *sp2, bool inPlace);
+
+SET *intersectSets(SET *sp1, SET *sp2, bool inPlace);
+
+SET *differenceSets(SET *sp1, SET *sp2, bool inPlace);
+
 # endif /* SET_H */
@@ -14,20 +14,66 @@
 
 
 #include "set.h"
+#include "stats.h"
 #include <assert.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
+
+#ifdef SETSTATS
+#define COUNT(x) ((x)++)
+#define RECORD(h, n) ((h)[statBucket(n)]++)
+#else
+#define COUNT(x) ((void) 0)
+#define RECORD(h, n) ((void) 0)
+#endif
+
+struct setiter {
+
+	SET *sp;
+	int next;
+
+};
 
 struct set {
 
 	char **elts;
+	uint64_t *keys;
 	int length;
 	int count;
+	struct setiter iter;
+#ifdef SETSTATS
+	struct setstats stats;
+#endif
 
 };
 
 
+/* Prefix
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns the first 8 bytes of a string as a
+ * big-endian integer, padded with zero bytes if the string
+ * is shorter, so that comparing two prefixes as integers
+ * orders them the same way strcmp would
+ *
+ */
+
+static uint64_t prefix(char *s){
+
+	uint64_t key = 0;
+	int i;
+	for(i = 0; i < 8; i++){
+		key <<= 8;
+		if(*s != '\0') key |= (unsigned char) *s++;
+	}
+	return key;
+
+}
+
+
 /* Search
  *
  * Complexity: O(log n)
@@ -35,7 +81,11 @@ struct set {
  * Description: Performs binary search over sorted set,
  * and returns the index of slot element should be at if 
  * not already in array, modifys boolean found to determine
- * if match was found within set
+ * if match was found within set. Each step compares the
+ * prefix kept in keys, which sit next to each other in
+ * memory, and only calls strcmp on the rest of the strings
+ * when the prefixes are equal. Equal prefixes with a zero
+ * byte mean both strings have ended, so they are equal
  *
  */
 
@@ -46,13 +96,25 @@ static int search(SET *sp, char *elt, bool *found){
 	int low = 0;
 	int comp;
 	int mid;
+	long probes = 0;
+	uint64_t key = prefix(elt);
 	while(low<=hi){
 	
 		mid = (hi+low)/2;
-		comp = strcmp(sp->elts[mid], elt);
+		probes++;
+
+		if(sp->keys[mid] != key) comp = sp->keys[mid] > key ? 1 : -1;
+
+		else if((key & 0xff) == 0) comp = 0;
+
+		else{
+			comp = strcmp(sp->elts[mid] + 8, elt + 8);
+			COUNT(sp->stats.compares);
+		}
 
 		if(comp == 0){
 
+			RECORD(sp->stats.probes, probes);
 			*found = true;
 			return mid;
 
@@ -64,6 +126,7 @@ static int search(SET *sp, char *elt, bool *found){
 		
 	}
 
+	RECORD(sp->stats.probes, probes);
 	*found = false;
 	return low;
 
@@ -86,9 +149,14 @@ SET *createSet(int maxElts){
 	assert(sp);
 	sp->elts = malloc(sizeof(char*) * maxElts);
 	assert(sp->elts);
+	sp->keys = malloc(sizeof(uint64_t) * maxElts);
+	assert(sp->keys);
 	sp->length = maxElts;
 	sp->count = 0;
-
+	sp->iter.sp = sp;
+#ifdef SETSTATS
+	memset(&sp->stats, 0, sizeof(struct setstats));
+#endif
 
 	return sp;
 
@@ -118,34 +186,83 @@ char *findElement(SET *sp, char *elt){
  *
  * Complexity: O(n)
  *
- * Description: Creates another set with length = count
- * of first set, uses for loop to populate second set, 
- * returns set
+ * Description: Creates an array with length = count
+ * of set, uses for loop to populate it, returns array
  *
  */
 
 char **getElements(SET *sp){
 
 
-	SET *sp2;
-	sp2 = malloc(sizeof(SET));
-	assert(sp2);
-	sp2->elts = malloc(sizeof(char*) * sp->count);
-	assert(sp->elts);
+	char **elts;
+	elts = malloc(sizeof(char*) * sp->count);
+	assert(elts);
 
 	int i;
 	for(i = 0; i < sp->count; i++){
 
-		sp2->elts[i] = sp->elts[i];
+		elts[i] = sp->elts[i];
 
 	}
 
-	return sp2->elts;
+	return elts;
 
 
 }
 
 
+/* Insert At
+ *
+ * Complexity: O(n)
+ *
+ * Description: Shifts the elements from index on up by 1
+ * slot and puts a copy of elt at index, returning the copy
+ *
+ */
+
+static char *insertAt(SET *sp, int index, char *elt){
+
+	assert(sp->count < sp->length);
+
+	int i;
+	for(i = sp->count; i > index; i--){
+		sp->elts[i] = sp->elts[i-1];
+		sp->keys[i] = sp->keys[i-1];
+	}
+	sp->elts[index] = strdup(elt);
+	sp->keys[index] = prefix(elt);
+	sp->count++;
+	return sp->elts[index];
+
+}
+
+
+/* Delete At
+ *
+ * Complexity: O(n)
+ *
+ * Description: Frees the element at index and shifts all
+ * elements after it down 1 slot
+ *
+ */
+
+static void deleteAt(SET *sp, int index){
+
+	free(sp->elts[index]);
+
+	int i;
+	for(i = index; i < sp->count-1; i++){
+	
+		sp->elts[i] = sp->elts[i+1];
+		sp->keys[i] = sp->keys[i+1];
+	
+	}
+
+	sp->count--;
+
+}
+
+
 /* Remove Element
  *
  * Complexity: O(n)
@@ -161,33 +278,29 @@ void removeElement(SET *sp, char *elt){
 	bool found;
 	int index = search(sp, elt, &found);
 	
-	if(found){
-			
-		free(sp->elts[index]);
-		int i;
-		for(i = index; i < sp->count; i++){
-		
-			sp->elts[i] = sp->elts[i+1];
-		
-		}
-
-		sp->count--;
-		
-	}
+	if(found) deleteAt(sp, index);
 
 }
 
 
 /* Destroy Set
  *
- * Complexity: O(1)
+ * Complexity: O(n)
  *
- * Description: Frees memory associated with set
+ * Description: Deletes set by freeing each element's
+ * copy, the arrays and then the set itself
  *
  */
 
 void destroySet(SET *sp){
 
+	assert(sp);
+
+	int i;
+	for(i = 0; i < sp->count; i++) free(sp->elts[i]);
+
+	free(sp->elts);
+	free(sp->keys);
 	free(sp);
 
 }
@@ -209,15 +322,53 @@ void addElement(SET *sp, char *elt){
 	bool found;
 	int index = search(sp, elt, &found);	
 
-	if(!found){
-	
-		int i;
-		for(i = sp->count; i > index; i--){
-			sp->elts[i] = sp->elts[i-1];
-		}
-		sp->elts[index] = strdup(elt);
-		sp->count++;
-	}
+	if(!found) insertAt(sp, index, elt);
+}
+
+
+/* Find Or Add Element
+ *
+ * Complexity: O(n)
+ *
+ * Description: Uses one search to either find the
+ * element or the index to insert it at, and returns the
+ * copy in the set
+ *
+ */
+
+char *findOrAddElement(SET *sp, char *elt, bool *inserted){
+
+	assert(sp && elt);
+	bool found;
+	int index = search(sp, elt, &found);
+
+	if(inserted) *inserted = !found;
+	if(found) return sp->elts[index];
+	return insertAt(sp, index, elt);
+
+}
+
+
+/* Toggle Element
+ *
+ * Complexity: O(n)
+ *
+ * Description: Uses one search to either remove the
+ * element or insert it where the search stopped, and
+ * returns whether it is now in the set
+ *
+ */
+
+bool toggleElement(SET *sp, char *elt){
+
+	assert(sp && elt);
+	bool found;
+	int index = search(sp, elt, &found);
+
+	if(found) deleteAt(sp, index);
+	else insertAt(sp, index, elt);
+	return !found;
+
 }
 
 
@@ -234,4 +385,281 @@ int numElements(SET *sp){
 	return sp->count;
 
 }
- 
+
+
+/* Begin Set
+ *
+ * Complexity: O(1)
+ *
+ * Description: Starts the set's iterator over at the
+ * first element and returns it
+ *
+ */
+
+SETITER *beginSet(SET *sp){
+
+	assert(sp);
+	sp->iter.next = 0;
+	return &sp->iter;
+
+}
+
+
+/* Next Element
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns the next element of the walk, in
+ * sorted order, or NULL once every element has been
+ * returned
+ *
+ */
+
+char *nextElement(SETITER *it){
+
+	assert(it);
+	if(it->next < it->sp->count) return it->sp->elts[it->next++];
+	return NULL;
+
+}
+
+
+/* For Each Element
+ *
+ * Complexity: O(n)
+ *
+ * Description: Calls fn with each element, in sorted
+ * order, and ctx
+ *
+ */
+
+void forEachElement(SET *sp, void (*fn)(), void *ctx){
+
+	assert(sp && fn);
+
+	int i;
+	for(i = 0; i < sp->count; i++) (*fn)(sp->elts[i], ctx);
+
+}
+
+
+/* Order
+ *
+ * Complexity: O(n) (for string length n)
+ *
+ * Description: Compares element i of sp1 with element j of
+ * sp2 as strcmp would, using their prefixes the same way
+ * search does
+ *
+ */
+
+static int order(SET *sp1, int i, SET *sp2, int j){
+
+	uint64_t key = sp1->keys[i];
+
+	if(key != sp2->keys[j]) return key > sp2->keys[j] ? 1 : -1;
+	if((key & 0xff) == 0) return 0;
+
+	COUNT(sp1->stats.compares);
+	return strcmp(sp1->elts[i] + 8, sp2->elts[j] + 8);
+
+}
+
+
+/* Append
+ *
+ * Complexity: O(n) (for string length n)
+ *
+ * Description: Adds a copy of element i of src to the end
+ * of dst, which must sort after every element already there
+ *
+ */
+
+static void append(SET *dst, SET *src, int i){
+
+	assert(dst->count < dst->length);
+	dst->elts[dst->count] = strdup(src->elts[i]);
+	dst->keys[dst->count++] = src->keys[i];
+
+}
+
+
+/* Union Sets
+ *
+ * Complexity: O(n + m)
+ *
+ * Description: Merges the two sorted arrays. A new set has
+ * room for both sets. In place, the elements of sp2 missing
+ * from sp1 are counted first, and the arrays are then
+ * merged from the back, so each element of sp1 moves once
+ * and nothing else is allocated. sp1 must have room for the
+ * elements added
+ *
+ */
+
+SET *unionSets(SET *sp1, SET *sp2, bool inPlace){
+
+	assert(sp1 && sp2 && sp1 != sp2);
+	SET *dst;
+	int i = 0, j = 0, k, comp;
+
+	if(!inPlace){
+
+		dst = createSet(sp1->length + sp2->length);
+
+		while(i < sp1->count && j < sp2->count){
+			comp = order(sp1, i, sp2, j);
+			if(comp <= 0) append(dst, sp1, i++);
+			else append(dst, sp2, j++);
+			if(comp == 0) j++;
+		}
+
+		while(i < sp1->count) append(dst, sp1, i++);
+		while(j < sp2->count) append(dst, sp2, j++);
+		return dst;
+
+	}
+
+	k = sp1->count;
+	while(i < sp1->count && j < sp2->count){
+		comp = order(sp1, i, sp2, j);
+		if(comp >= 0) j++;
+		if(comp <= 0) i++;
+		if(comp > 0) k++;
+	}
+
+	k += sp2->count - j;
+	assert(k <= sp1->length);
+
+	i = sp1->count - 1;
+	j = sp2->count - 1;
+	sp1->count = k;
+
+	while(j >= 0){
+		comp = i >= 0 ? order(sp1, i, sp2, j) : -1;
+		k--;
+
+		if(comp < 0){
+			sp1->elts[k] = strdup(sp2->elts[j]);
+			sp1->keys[k] = sp2->keys[j--];
+		}
+
+		else{
+			sp1->elts[k] = sp1->elts[i];
+			sp1->keys[k] = sp1->keys[i--];
+			if(comp == 0) j--;
+		}
+	}
+
+	return sp1;
+
+}
+
+
+/* Filter
+ *
+ * Complexity: O(n + m)
+ *
+ * Description: Merges the two sorted arrays, keeping the
+ * elements of sp1 that are in sp2 if keep is true and those
+ * that are not otherwise. In place, the kept elements are
+ * moved down over the others, which are freed
+ *
+ */
+
+static SET *filter(SET *sp1, SET *sp2, bool inPlace, bool keep){
+
+	SET *dst = inPlace ? sp1 : createSet(sp1->length);
+	int i, j = 0, k = 0, comp;
+	bool found;
+
+	for(i = 0; i < sp1->count; i++){
+
+		comp = 1;
+		while(j < sp2->count && (comp = order(sp1, i, sp2, j)) > 0) j++;
+		found = j < sp2->count && comp == 0;
+
+		if(found != keep){
+			if(inPlace) free(sp1->elts[i]);
+		}
+
+		else if(inPlace){
+			sp1->elts[k] = sp1->elts[i];
+			sp1->keys[k++] = sp1->keys[i];
+		}
+
+		else append(dst, sp1, i);
+
+	}
+
+	if(inPlace) sp1->count = k;
+	return dst;
+
+}
+
+
+/* Intersect Sets
+ *
+ * Complexity: O(n + m)
+ *
+ * Description: Returns the elements of sp1 that are also
+ * in sp2, using filter
+ *
+ */
+
+SET *intersectSets(SET *sp1, SET *sp2, bool inPlace){
+
+	assert(sp1 && sp2 && sp1 != sp2);
+	return filter(sp1, sp2, inPlace, true);
+
+}
+
+
+/* Difference Sets
+ *
+ * Complexity: O(n + m)
+ *
+ * Description: Returns the elements of sp1 that are not
+ * in sp2, using filter
+ *
+ */
+
+SET *differenceSets(SET *sp1, SET *sp2, bool inPlace){
+
+	assert(sp1 && sp2 && sp1 != sp2);
+	return filter(sp1, sp2, inPlace, false);
+
+}
+
+
+/* Get Set Stats
+ *
+ * Complexity: O(n)
+ *
+ * Description: Fills in stats for the set. The array is
+ * never hashed, so there are no tombstones or chains, and
+ * the bytes include the copies of the strings
+ *
+ */
+
+void getSetStats(SET *sp, struct setstats *stats){
+
+	assert(sp && stats);
+	memset(stats, 0, sizeof(struct setstats));
+	stats->count = sp->count;
+	stats->length = sp->length;
+	stats->bytes = sizeof(SET) + (sizeof(char*) + sizeof(uint64_t)) * sp->length;
+
+	int i;
+	for(i = 0; i < sp->count; i++) stats->bytes += strlen(sp->elts[i]) + 1;
+
+#ifdef SETSTATS
+	stats->compares = sp->stats.compares;
+	stats->hashes = sp->stats.hashes;
+	memcpy(stats->probes, sp->stats.probes, sizeof(stats->probes));
+#else
+	stats->compares = -1;
+	stats->hashes = -1;
+#endif
+
+}
@@ -19,6 +19,7 @@
 # include <string.h>
 # include <stdbool.h>
 # include "set.h"
+# include "stats.h"
 
 
 /* This is sufficient for the test cases in /scratch/coen12. */
@@ -35,16 +36,24 @@
 int main(int argc, char *argv[])
 {
     FILE *fp;
-    char buffer[BUFSIZ], **elts;
+    char buffer[BUFSIZ], *elt;
     SET *unique;
+    struct setstats stats;
+    SETITER *it;
     int i, words;
-    bool lflag = false;
+    bool lflag = false, sflag = false;
 
 
     /* Check usage and open the first file. */
 
-    if (argc > 1 && strcmp(argv[1], "-l") == 0) {
-	lflag = true;
+    while (argc > 1 && argv[1][0] == '-') {
+	if (strcmp(argv[1], "-l") == 0)
+	    lflag = true;
+	else if (strcmp(argv[1], "-s") == 0)
+	    sflag = true;
+	else
+	    break;
+
 	argc --;
 
 	for (i = 1; i < argc; i ++)
@@ -52,7 +61,7 @@ int main(int argc, char *argv[])
     }
 
     if (argc == 1 || argc > 3) {
-        fprintf(stderr, "usage: %s [-l] file1 [file2]\n", argv[0]);
+        fprintf(stderr, "usage: %s [-l] [-s] file1 [file2]\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
@@ -104,12 +113,15 @@ int main(int argc, char *argv[])
     /* Print the list of words if desired. */
 
     if (lflag) {
-	elts = getElements(unique);
+	it = beginSet(unique);
 
-	for (i = 0; i < numElements(unique); i ++)
-	    printf("%s\n", elts[i]);
+	while ((elt = nextElement(it)) != NULL)
+	    printf("%s\n", elt);
+    }
 
-	free(elts);
+    if (sflag) {
+	getSetStats(unique, &stats);
+	printStats(&stats);
     }
 
     destroySet(unique);
@@ -9,43 +9,162 @@
  * Description: Program contains methods to create set,
  * as well as modify elements inside set including adding
  * and removing, as well as functions to return copy of set
- * and search elements in the set. Set is unsorted
+ * and search elements in the set. Set is unsorted.
+ * Alongside each element the set keeps its length and its
+ * first 8 bytes, packed into arrays of their own, so that a
+ * search can scan the prefixes several at a time with
+ * vector compares (AVX2 if compiled with -mavx2, otherwise
+ * SSE2 on x86-64, otherwise one at a time) and only look at
+ * the strings themselves for prefixes that match
  *
  */
 
 
 
 #include "set.h"
+#include "stats.h"
 #include <assert.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#ifdef SETSTATS
+#define COUNT(x) ((x)++)
+#define RECORD(h, n) ((h)[statBucket(n)]++)
+#else
+#define COUNT(x) ((void) 0)
+#define RECORD(h, n) ((void) 0)
+#endif
+
+struct setiter {
+
+	SET *sp;
+	int next;
+
+};
 
 struct set {
 
 	char **elts;
+	uint64_t *keys;
+	int *lens;
 	int length;
 	int count;
+	struct setiter iter;
+#ifdef SETSTATS
+	struct setstats stats;
+#endif
 
 };
 
+
+/* Prefix
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns the first 8 bytes of a string of
+ * length len as an integer, padded with zero bytes if the
+ * string is shorter
+ *
+ */
+
+static uint64_t prefix(char *s, int len){
+
+	uint64_t key = 0;
+	memcpy(&key, s, len < 8 ? len : 8);
+	return key;
+
+}
+
+
+/* Match
+ *
+ * Complexity: O(n) (for string length n)
+ *
+ * Description: Returns whether the element at index i,
+ * whose prefix is already known to match, is equal to elt
+ * of length len. Strings of 8 bytes or fewer are wholly in
+ * the prefix, so strcmp is only called on longer strings,
+ * and only on the bytes after the prefix
+ *
+ */
+
+static int match(SET *sp, int i, char *elt, int len){
+
+	if(sp->lens[i] != len) return 0;
+	if(len <= 8) return 1;
+	COUNT(sp->stats.compares);
+	return strcmp(sp->elts[i] + 8, elt + 8) == 0;
+
+}
+
+
 /* Search
  *
  * Complexity: O(n)
  *
  * Description: Performs linear search over entire array,
- * returning index of element if found, and -1 if not found
+ * returning index of element if found, and -1 if not found.
+ * The prefixes are compared four at a time with AVX2 or two
+ * at a time with SSE2, and each matching prefix is checked
+ * with match. The elements left over are compared one at
+ * a time
  *
  */ 
 
 static int search(SET *sp, char *elt){
 
-	int i;
-	for(i = 0; i <= sp->count-1; i++){
+	int len = strlen(elt);
+	uint64_t key = prefix(elt, len);
+	int i = 0;
+
+#if defined(__AVX2__)
+	unsigned mask;
+	int j;
+	__m256i want = _mm256_set1_epi64x(key);
+	for(; i + 4 <= sp->count; i += 4){
+		__m256i have = _mm256_loadu_si256((__m256i *) (sp->keys + i));
+		mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(have, want)));
+		while(mask != 0){
+			j = i + __builtin_ctz(mask);
+			if(match(sp, j, elt, len)){
+				RECORD(sp->stats.probes, j+1);
+				return j;
+			}
+			mask &= mask - 1;
+		}
+	}
+#elif defined(__SSE2__)
+	unsigned mask;
+	__m128i want = _mm_set1_epi64x(key);
+	for(; i + 2 <= sp->count; i += 2){
+		__m128i have = _mm_loadu_si128((__m128i *) (sp->keys + i));
+		mask = _mm_movemask_epi8(_mm_cmpeq_epi32(have, want));
+		if((mask & 0xff) == 0xff && match(sp, i, elt, len)){
+			RECORD(sp->stats.probes, i+1);
+			return i;
+		}
+		if((mask >> 8) == 0xff && match(sp, i+1, elt, len)){
+			RECORD(sp->stats.probes, i+2);
+			return i+1;
+		}
+	}
+#endif
+
+	for(; i < sp->count; i++){
 
-		if(strcmp(sp->elts[i], elt) == 0) return i;
+		if(sp->keys[i] == key && match(sp, i, elt, len)){
+			RECORD(sp->stats.probes, i+1);
+			return i;
+		}
 
 	}
 
+	RECORD(sp->stats.probes, sp->count);
 	return -1;
 
 }
@@ -66,9 +185,15 @@ SET *createSet(int maxElts){
 	assert(sp);
 	sp->elts = malloc(sizeof(char*) * maxElts);
 	assert(sp->elts);
+	sp->keys = malloc(sizeof(uint64_t) * maxElts);
+	sp->lens = malloc(sizeof(int) * maxElts);
+	assert(sp->keys && sp->lens);
 	sp->length = maxElts;
 	sp->count = 0;
-
+	sp->iter.sp = sp;
+#ifdef SETSTATS
+	memset(&sp->stats, 0, sizeof(struct setstats));
+#endif
 
 	return sp;
 
@@ -98,9 +223,9 @@ char *findElement(SET *sp, char *elt){
  *
  * Complexity: O(n)
  *
- * Description: Creates another set with length equal
- * to count of original set and populates with data from
- * original set, returns copy set
+ * Description: Creates an array with length equal
+ * to count of set and populates with data from set,
+ * returns array
  *
  */
 
@@ -108,25 +233,60 @@ char *findElement(SET *sp, char *elt){
 char **getElements(SET *sp){
 
 
-	SET *sp2;
-	sp2 = malloc(sizeof(SET));
-	assert(sp2);
-	sp2->elts = malloc(sizeof(char*) * sp->count);
-	assert(sp->elts);
+	char **elts;
+	elts = malloc(sizeof(char*) * sp->count);
+	assert(elts);
 
 	int i;
 	for(i = 0; i < sp->count; i++){
 
-		sp2->elts[i] = sp->elts[i];
+		elts[i] = sp->elts[i];
 
 	}
 
-	return sp2->elts;
+	return elts;
 
 
 }
 
 
+/* Push
+ *
+ * Complexity: O(n) (for string length n)
+ *
+ * Description: Adds a copy of elt to the end of the set,
+ * along with its length and prefix, and returns the copy
+ *
+ */
+
+static char *push(SET *sp, char *elt){
+
+	sp->lens[sp->count] = strlen(elt);
+	sp->keys[sp->count] = prefix(elt, sp->lens[sp->count]);
+	return sp->elts[sp->count++] = strdup(elt);
+
+}
+
+
+/* Drop
+ *
+ * Complexity: O(1)
+ *
+ * Description: Frees element i and moves the last element
+ * into its place, as removeElement does
+ *
+ */
+
+static void drop(SET *sp, int i){
+
+	free(sp->elts[i]);
+	sp->elts[i] = sp->elts[--sp->count];
+	sp->keys[i] = sp->keys[sp->count];
+	sp->lens[i] = sp->lens[sp->count];
+
+}
+
+
 /* Remove Element
  *
  * Complexity: O(n)
@@ -141,27 +301,30 @@ void removeElement(SET *sp, char *elt){
 
 	int index = search(sp, elt);
 	
-	if(index != -1){
-			
-		free(sp->elts[index]);
-		sp->elts[index] = sp->elts[--sp->count]; 
-		
-		
-	}
+	if(index != -1) drop(sp, index);
 
 }
 
 
 /* Destroy Set
  *
- * Complexity: O(1)
+ * Complexity: O(n)
  *
- * Description: Deletes set by freeing all memory associated
+ * Description: Deletes set by freeing each element's
+ * copy, the arrays and then the set itself
  *
  */
 
 void destroySet(SET *sp){
 
+	assert(sp);
+
+	int i;
+	for(i = 0; i < sp->count; i++) free(sp->elts[i]);
+
+	free(sp->elts);
+	free(sp->keys);
+	free(sp->lens);
 	free(sp);
 
 }
@@ -182,9 +345,57 @@ void addElement(SET *sp, char *elt){
 	assert(elt);
 	assert(sp->count < sp->length);
 
-	if(search(sp, elt) == -1){
-		sp->elts[sp->count++] = strdup(elt);
+	if(search(sp, elt) == -1) push(sp, elt);
+}
+
+
+/* Find Or Add Element
+ *
+ * Complexity: O(n)
+ *
+ * Description: Searches once for element, adding it to
+ * the end of the set if it is not found, and returns the
+ * copy in the set
+ *
+ */
+
+char *findOrAddElement(SET *sp, char *elt, bool *inserted){
+
+	assert(sp && elt);
+	int index = search(sp, elt);
+
+	if(inserted) *inserted = index == -1;
+	if(index != -1) return sp->elts[index];
+
+	assert(sp->count < sp->length);
+	return push(sp, elt);
+
+}
+
+
+/* Toggle Element
+ *
+ * Complexity: O(n)
+ *
+ * Description: Searches once for element, removing it if
+ * it is found and adding it to the end of the set if not,
+ * and returns whether it is now in the set
+ *
+ */
+
+bool toggleElement(SET *sp, char *elt){
+
+	assert(sp && elt);
+	int index = search(sp, elt);
+
+	if(index != -1) drop(sp, index);
+	else{
+		assert(sp->count < sp->length);
+		push(sp, elt);
 	}
+
+	return index == -1;
+
 }
 
 
@@ -201,4 +412,208 @@ int numElements(SET *sp){
 	return sp->count;
 
 }
- 
+
+
+/* Begin Set
+ *
+ * Complexity: O(1)
+ *
+ * Description: Starts the set's iterator over at the
+ * first element and returns it
+ *
+ */
+
+SETITER *beginSet(SET *sp){
+
+	assert(sp);
+	sp->iter.next = 0;
+	return &sp->iter;
+
+}
+
+
+/* Next Element
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns the next element of the walk, or
+ * NULL once every element has been returned
+ *
+ */
+
+char *nextElement(SETITER *it){
+
+	assert(it);
+	if(it->next < it->sp->count) return it->sp->elts[it->next++];
+	return NULL;
+
+}
+
+
+/* For Each Element
+ *
+ * Complexity: O(n)
+ *
+ * Description: Calls fn with each element and ctx
+ *
+ */
+
+void forEachElement(SET *sp, void (*fn)(), void *ctx){
+
+	assert(sp && fn);
+
+	int i;
+	for(i = 0; i < sp->count; i++) (*fn)(sp->elts[i], ctx);
+
+}
+
+
+/* Append
+ *
+ * Complexity: O(n) (for string length n)
+ *
+ * Description: Adds a copy of element i of src to the end
+ * of dst, along with its length and prefix, without
+ * checking whether dst already has it
+ *
+ */
+
+static void append(SET *dst, SET *src, int i){
+
+	assert(dst->count < dst->length);
+	dst->lens[dst->count] = src->lens[i];
+	dst->keys[dst->count] = src->keys[i];
+	dst->elts[dst->count++] = strdup(src->elts[i]);
+
+}
+
+
+/* Union Sets
+ *
+ * Complexity: O(nm)
+ *
+ * Description: Adds each element of sp2 that is not found
+ * by search to sp1, or to a new set with room for both sets
+ * that starts with copies of sp1's elements. In place, sp1
+ * must have room for the elements added
+ *
+ */
+
+SET *unionSets(SET *sp1, SET *sp2, bool inPlace){
+
+	assert(sp1 && sp2 && sp1 != sp2);
+	SET *dst = sp1;
+
+	int i;
+	if(!inPlace){
+		dst = createSet(sp1->length + sp2->length);
+		for(i = 0; i < sp1->count; i++) append(dst, sp1, i);
+	}
+
+	for(i = 0; i < sp2->count; i++)
+		if(search(dst, sp2->elts[i]) == -1) append(dst, sp2, i);
+
+	return dst;
+
+}
+
+
+/* Intersect Sets
+ *
+ * Complexity: O(nm)
+ *
+ * Description: Returns the elements of sp1 that are also
+ * in sp2. A new set walks the smaller set and searches the
+ * other. In place, sp1 is walked from the back, so that
+ * each element dropped is replaced by one already kept
+ *
+ */
+
+SET *intersectSets(SET *sp1, SET *sp2, bool inPlace){
+
+	assert(sp1 && sp2 && sp1 != sp2);
+	SET *dst, *small = sp1, *large = sp2;
+
+	int i;
+	if(inPlace){
+		for(i = sp1->count - 1; i >= 0; i--)
+			if(search(sp2, sp1->elts[i]) == -1) drop(sp1, i);
+		return sp1;
+	}
+
+	if(sp2->count < sp1->count){
+		small = sp2;
+		large = sp1;
+	}
+
+	dst = createSet(small->length);
+	for(i = 0; i < small->count; i++)
+		if(search(large, small->elts[i]) != -1) append(dst, small, i);
+
+	return dst;
+
+}
+
+
+/* Difference Sets
+ *
+ * Complexity: O(nm)
+ *
+ * Description: Returns the elements of sp1 that are not
+ * in sp2. In place, sp1 is walked from the back as for
+ * intersectSets
+ *
+ */
+
+SET *differenceSets(SET *sp1, SET *sp2, bool inPlace){
+
+	assert(sp1 && sp2 && sp1 != sp2);
+	SET *dst;
+
+	int i;
+	if(inPlace){
+		for(i = sp1->count - 1; i >= 0; i--)
+			if(search(sp2, sp1->elts[i]) != -1) drop(sp1, i);
+		return sp1;
+	}
+
+	dst = createSet(sp1->length);
+	for(i = 0; i < sp1->count; i++)
+		if(search(sp2, sp1->elts[i]) == -1) append(dst, sp1, i);
+
+	return dst;
+
+}
+
+
+/* Get Set Stats
+ *
+ * Complexity: O(n)
+ *
+ * Description: Fills in stats for the set. The array is
+ * never hashed, so there are no tombstones or chains, and
+ * the bytes include the copies of the strings
+ *
+ */
+
+void getSetStats(SET *sp, struct setstats *stats){
+
+	assert(sp && stats);
+	memset(stats, 0, sizeof(struct setstats));
+	stats->count = sp->count;
+	stats->length = sp->length;
+	stats->bytes = sizeof(SET) + (sizeof(char*) + sizeof(uint64_t) + sizeof(int)) * sp->length;
+
+	int i;
+	for(i = 0; i < sp->count; i++) stats->bytes += strlen(sp->elts[i]) + 1;
+
+#ifdef SETSTATS
+	stats->compares = sp->stats.compares;
+	stats->hashes = sp->stats.hashes;
+	memcpy(stats->probes, sp->stats.probes, sizeof(stats->probes));
+#else
+	stats->compares = -1;
+	stats->hashes = -1;
+#endif
+
+}
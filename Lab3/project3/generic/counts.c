@@ -3,69 +3,86 @@
  *
  * Copyright:	2021, Darren C. Atkinson
  *
- * Description: This file contains the main function for testing a set
+ * Description: This file contains the main function for testing a map
  *              abstract data type for strings.
  *
  *              The program takes one file as a command line argument and
  *              counts the number of times each word appears in the file.
+ *              Each word is a key of the map and its count is the key's
+ *              value, kept in the same slot as the key, so counting a word
+ *              already seen changes the slot that was found and touches no
+ *              other memory.  Words are read in blocks, and each block is
+ *              counted with a single call so that the map can overlap the
+ *              memory accesses for different words.  The map copies each
+ *              new word into its own arena, and frees every copy at once
+ *              when it is destroyed.
+ *
+ *              With -k, only the given number of most frequent words are
+ *              printed, most frequent first, and the map picks them out
+ *              without sorting every word.
  */
 
 # include <stdio.h>
 # include <stdlib.h>
 # include <string.h>
+# include <stdbool.h>
 # include <assert.h>
-# include "set.h"
-
-struct entry {
-    char *word;
-    int count;
-};
-
+# include <time.h>
+# include <unistd.h>
+# include "map.h"
+# include "tableutil.h"
+# include "hash.h"
 
 /* This is sufficient for the test cases in /scratch/coen12. */
 
 # define MAX_SIZE 18000
 
+# define BLOCK_SIZE 64
+
+static unsigned (*hash)() = strhash;
+
 
 /*
- * Function:    strhash
+ * Function:	wordSize
  *
- * Description: Return a hash value for a string S.
+ * Description:	Return the number of bytes in a word, null included.
  */
 
-static unsigned strhash(char *s)
+static size_t wordSize(char *word)
 {
-    unsigned hash = 0;
-
-
-    while (*s != '\0')
-        hash = 31 * hash + *s ++;
-
-    return hash;
+    return strlen(word) + 1;
 }
 
 
 /*
- * Function:	hashEntry
+ * Function:	printCount
  *
- * Description:	Return a hash value for an entry based on its word.
+ * Description:	Print a word and its count on the stream FP.
  */
 
-static unsigned hashEntry(struct entry *ep)
+static void printCount(char *word, long count, FILE *fp)
 {
-    return strhash(ep->word);
+    fprintf(fp, "%s: %ld\n", word, count);
 }
 
 
 /*
- * Function:	compareEntries
+ * Function:    readBlock
  *
- * Description:	Compare two entries as in strcmp().
+ * Description: Read up to BLOCK_SIZE words from FP into the buffers
+ *              pointed to by BLOCK and return the number read.
  */
 
-static int compareEntries(struct entry *ep1, struct entry *ep2)
+static int readBlock(FILE *fp, char **block)
 {
-    return strcmp(ep1->word, ep2->word);
+    int n;
+
+
+    for (n = 0; n < BLOCK_SIZE; n ++)
+	if (fscanf(fp, "%s", block[n]) != 1)
+	    break;
+
+    return n;
 }
 
 
@@ -78,16 +95,47 @@ static int compareEntries(struct entry *ep1, struct entry *ep2)
 int main(int argc, char *argv[])
 {
     FILE *fp;
-    char buffer[BUFSIZ];
-    struct entry e, *ep, **entries;
-    SET *counts;
-    int i;
+    char *block[BLOCK_SIZE], **words;
+    long *values;
+    MAP *counts;
+    struct setstats stats;
+    int i, j, k, n;
+    bool dflag = false, sflag = false;
 
 
     /* Check usage and open the file. */
 
-    if (argc != 2) {
-        fprintf(stderr, "usage: %s file\n", argv[0]);
+    k = 0;
+
+    while (argc > 1 && argv[1][0] == '-') {
+	if (strcmp(argv[1], "-d") == 0) {
+	    dflag = true;
+	    j = 1;
+
+	} else if (strcmp(argv[1], "-s") == 0) {
+	    sflag = true;
+	    j = 1;
+
+	} else if (strcmp(argv[1], "-h") == 0 && argc > 2) {
+	    hash = findHash(argv[2]);
+	    j = 2;
+
+	} else if (strcmp(argv[1], "-k") == 0 && argc > 2) {
+	    k = atoi(argv[2]);
+	    j = 2;
+
+	} else
+	    break;
+
+	argc -= j;
+
+	for (i = 1; i < argc; i ++)
+	    argv[i] = argv[i + j];
+    }
+
+    if (argc != 2 || hash == NULL || k < 0) {
+        fprintf(stderr, "usage: %s [-s] [-d] [-h hash] [-k count] file\n",
+	    argv[0]);
         exit(EXIT_FAILURE);
     }
 
@@ -99,39 +147,49 @@ int main(int argc, char *argv[])
 
     /* Increment the count on each word read. */
 
-    counts = createSet(MAX_SIZE, compareEntries, hashEntry);
+    setHashSeed(time(NULL) ^ getpid());
+    counts = createMap(MAX_SIZE, strcmp, hash, wordSize);
 
-    while (fscanf(fp, "%s", buffer) == 1) {
-	e.word = buffer;
-	ep = findElement(counts, &e);
+    for (i = 0; i < BLOCK_SIZE; i ++) {
+	block[i] = malloc(BUFSIZ);
+	assert(block[i] != NULL);
+    }
 
-	if (ep == NULL) {
-	    ep = malloc(sizeof(struct entry));
-	    assert(ep != NULL);
+    while ((n = readBlock(fp, block)) > 0)
+	incrementKeys(counts, (void **) block, n, 1);
 
-	    ep->word = strdup(buffer);
-	    assert(ep->word != NULL);
+    for (i = 0; i < BLOCK_SIZE; i ++)
+	free(block[i]);
 
-	    ep->count = 1;
-	    addElement(counts, ep);
 
-	} else
-	    ep->count ++;
-    }
+    /* Print out the counts for each word, or only the top K. */
 
+    if (k > 0) {
+	words = malloc(sizeof(char *) * k);
+	values = malloc(sizeof(long) * k);
+	assert(words != NULL && values != NULL);
+	n = selectTopKeys(counts, (void **) words, values, k);
 
-    /* Print out the counts for each word. */
+	for (i = 0; i < n; i ++)
+	    printf("%s: %ld\n", words[i], values[i]);
 
-    entries = getElements(counts);
+	free(words);
+	free(values);
+    } else
+	forEachKey(counts, printCount, stdout);
 
-    for (i = 0; i < numElements(counts); i ++) {
-	printf("%s: %d\n", entries[i]->word, entries[i]->count);
-	free(entries[i]->word);
-	free(entries[i]);
+    if (dflag) {
+	words = getKeys(counts);
+	getMapStats(counts, &stats);
+	reportHash(stderr, words, numKeys(counts), stats.length, hash);
+	free(words);
     }
 
-    free(entries);
+    if (sflag) {
+	getMapStats(counts, &stats);
+	printStats(&stats);
+    }
 
-    destroySet(counts);
+    destroyMap(counts);
     exit(EXIT_SUCCESS);
 }
@@ -0,0 +1,180 @@
+/*
+ * File:        freeze.c
+ *
+ * Author:      Riley Heike
+ *
+ * Description: This file contains the main function for checking that a
+ *              set can be frozen into a minimal perfect hash table.
+ *
+ *              A set of generated words is frozen and every word is looked
+ *              up, along with words that were never added.  The same is
+ *              done for a set whose hash function sends every word to one
+ *              of seven values, and for "Aa" and "BB", which share a hash
+ *              with strhash, along with "C#", which has that hash too but
+ *              is never added.  The program prints what failed, if
+ *              anything, and exits with a failure status if anything did.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <stdbool.h>
+# include "set.h"
+# include "hash.h"
+
+# define NUM_WORDS 5000
+
+static int failures;
+
+
+/*
+ * Function:    check
+ *
+ * Description: Report a failure with message MSG if COND is false.
+ */
+
+static void check(bool cond, char *msg)
+{
+    if (!cond) {
+	fprintf(stderr, "freeze: %s\n", msg);
+	failures ++;
+    }
+}
+
+
+/*
+ * Function:    collide
+ *
+ * Description: Return a hash value for a string S that takes only seven
+ *              values, so that many strings share each one.
+ */
+
+static unsigned collide(char *s)
+{
+    return strhash(s) % 7;
+}
+
+
+/*
+ * Function:    makeWords
+ *
+ * Description: Return an array of N distinct words, each starting with
+ *              PREFIX.
+ */
+
+static char **makeWords(char *prefix, int n)
+{
+    char buffer[BUFSIZ], **words;
+    int i;
+
+
+    words = malloc(sizeof(char *) * n);
+
+    for (i = 0; words != NULL && i < n; i ++) {
+	sprintf(buffer, "%s%d", prefix, i);
+
+	if ((words[i] = strdup(buffer)) == NULL) {
+	    fprintf(stderr, "out of memory\n");
+	    exit(EXIT_FAILURE);
+	}
+    }
+
+    if (words == NULL) {
+	fprintf(stderr, "out of memory\n");
+	exit(EXIT_FAILURE);
+    }
+
+    return words;
+}
+
+
+/*
+ * Function:    findAll
+ *
+ * Description: Return whether each of the N words is found in the set SP
+ *              and each of the N misses is not.
+ */
+
+static bool findAll(SET *sp, char **words, char **misses, int n)
+{
+    int i;
+
+
+    for (i = 0; i < n; i ++)
+	if (findElement(sp, words[i]) != words[i]
+	    || findElement(sp, misses[i]) != NULL)
+	    return false;
+
+    return true;
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the test.
+ */
+
+int main(void)
+{
+    char **words, **misses;
+    SET *sp;
+    int i;
+
+
+    words = makeWords("word", NUM_WORDS);
+    misses = makeWords("miss", NUM_WORDS);
+    setHashSeed(1);
+
+
+    /* Freeze a set whose hashes are distinct. */
+
+    sp = createSet(NUM_WORDS * 2, strcmp, strhash);
+
+    for (i = 0; i < NUM_WORDS; i ++)
+	addElement(sp, words[i]);
+
+    check(freezeSet(sp), "freezing distinct hashes failed");
+    check(numElements(sp) == NUM_WORDS, "frozen set lost elements");
+    check(findAll(sp, words, misses, NUM_WORDS), "frozen set finds wrongly");
+    destroySet(sp);
+
+
+    /* Freeze a set whose hashes collide. */
+
+    sp = createSet(NUM_WORDS * 2, strcmp, collide);
+
+    for (i = 0; i < NUM_WORDS; i ++)
+	addElement(sp, words[i]);
+
+    check(freezeSet(sp), "freezing equal hashes failed");
+    check(numElements(sp) == NUM_WORDS, "frozen extras lost elements");
+    check(findAll(sp, words, misses, NUM_WORDS), "frozen extras find wrongly");
+    destroySet(sp);
+
+
+    /* Freeze two words that share a hash with strhash. */
+
+    sp = createSet(4, strcmp, strhash);
+    addElement(sp, "Aa");
+    addElement(sp, "BB");
+
+    check(freezeSet(sp), "freezing Aa and BB failed");
+    check(findElement(sp, "Aa") != NULL && findElement(sp, "BB") != NULL
+	&& findElement(sp, "C#") == NULL, "frozen Aa and BB find wrongly");
+    destroySet(sp);
+
+    for (i = 0; i < NUM_WORDS; i ++) {
+	free(words[i]);
+	free(misses[i]);
+    }
+
+    free(words);
+    free(misses);
+
+    if (failures > 0)
+	exit(EXIT_FAILURE);
+
+    printf("freeze: all checks passed\n");
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,274 @@
+/*
+ * File:        hash.c
+ *
+ * Author:      Riley Heike
+ *
+ * Description: This file contains the definitions of several string hash
+ *              functions shared by the drivers, so that each driver no
+ *              longer carries its own copy:
+ *
+ *              31      the classic hash = 31 * hash + c, one byte at a time
+ *              fnv     32-bit FNV-1a, one byte at a time
+ *              word    eight bytes at a time with a 64-bit multiply, then
+ *                      a final mix so that every input bit affects the
+ *                      low bits used to pick a slot
+ *              sip     SipHash-1-3 keyed by the seed given to setHashSeed,
+ *                      so that the slots chosen cannot be predicted from
+ *                      the input alone
+ *
+ *              reportHash prints the chi-square statistic of the slot
+ *              counts and the longest linear probe a table would need, so
+ *              that a poor hash can be spotted on a real corpus.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <stdint.h>
+# include <math.h>
+# include "hash.h"
+
+# define ROTL(x, b)	(((x) << (b)) | ((x) >> (64 - (b))))
+
+static uint64_t k0 = 0x0706050403020100ULL;
+static uint64_t k1 = 0x0f0e0d0c0b0a0908ULL;
+
+static struct {
+    char *name;
+    unsigned (*hash)();
+} hashes[] = {
+    { "31", strhash },
+    { "fnv", fnvhash },
+    { "word", wordhash },
+    { "sip", siphash },
+    { NULL, NULL },
+};
+
+
+/*
+ * Function:    strhash
+ *
+ * Description: Return a hash value for a string S.
+ */
+
+unsigned strhash(char *s)
+{
+    unsigned hash = 0;
+
+
+    while (*s != '\0')
+        hash = 31 * hash + *s ++;
+
+    return hash;
+}
+
+
+/*
+ * Function:    fnvhash
+ *
+ * Description: Return the 32-bit FNV-1a hash value for a string S.
+ */
+
+unsigned fnvhash(char *s)
+{
+    unsigned hash = 2166136261u;
+
+
+    while (*s != '\0') {
+	hash ^= (unsigned char) *s ++;
+	hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+
+/*
+ * Function:    wordhash
+ *
+ * Description: Return a hash value for a string S, consuming eight bytes
+ *              per step.  The final mix is the one from MurmurHash3.
+ */
+
+unsigned wordhash(char *s)
+{
+    size_t len;
+    uint64_t hash, word;
+
+
+    len = strlen(s);
+    hash = len * 0x9e3779b97f4a7c15ULL;
+
+    for (; len >= 8; len -= 8, s += 8) {
+	memcpy(&word, s, 8);
+	hash = ROTL(hash ^ (word * 0x87c37b91114253d5ULL), 31);
+	hash = hash * 5 + 0x52dce729;
+    }
+
+    word = 0;
+    memcpy(&word, s, len);
+    hash ^= word * 0x4cf5ad432745937fULL;
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+
+    return (unsigned) hash;
+}
+
+
+/*
+ * Function:    siphash
+ *
+ * Description: Return the low 32 bits of the SipHash-1-3 value for a
+ *              string S, keyed by the current seed.
+ */
+
+unsigned siphash(char *s)
+{
+    size_t len, i;
+    uint64_t v0, v1, v2, v3, m;
+
+
+# define SIPROUND \
+    do { \
+	v0 += v1; v1 = ROTL(v1, 13); v1 ^= v0; v0 = ROTL(v0, 32); \
+	v2 += v3; v3 = ROTL(v3, 16); v3 ^= v2; \
+	v0 += v3; v3 = ROTL(v3, 21); v3 ^= v0; \
+	v2 += v1; v1 = ROTL(v1, 17); v1 ^= v2; v2 = ROTL(v2, 32); \
+    } while (0)
+
+    len = strlen(s);
+    v0 = k0 ^ 0x736f6d6570736575ULL;
+    v1 = k1 ^ 0x646f72616e646f6dULL;
+    v2 = k0 ^ 0x6c7967656e657261ULL;
+    v3 = k1 ^ 0x7465646279746573ULL;
+
+    for (i = 0; i + 8 <= len; i += 8) {
+	memcpy(&m, s + i, 8);
+	v3 ^= m;
+	SIPROUND;
+	v0 ^= m;
+    }
+
+    m = (uint64_t) len << 56;
+    memcpy(&m, s + i, len - i);
+    m |= (uint64_t) len << 56;
+
+    v3 ^= m;
+    SIPROUND;
+    v0 ^= m;
+
+    v2 ^= 0xff;
+    SIPROUND;
+    SIPROUND;
+    SIPROUND;
+
+# undef SIPROUND
+
+    return (unsigned) (v0 ^ v1 ^ v2 ^ v3);
+}
+
+
+/*
+ * Function:    setHashSeed
+ *
+ * Description: Derive the key used by the keyed hash functions from SEED.
+ */
+
+void setHashSeed(unsigned long seed)
+{
+    uint64_t x = seed;
+
+
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    k0 = x * 0x94d049bb133111ebULL;
+    k1 = ROTL(k0, 32) ^ 0x9e3779b97f4a7c15ULL;
+}
+
+
+/*
+ * Function:    findHash
+ *
+ * Description: Return the hash function called NAME, or NULL if there is
+ *              none.
+ */
+
+unsigned (*findHash(char *name))()
+{
+    int i;
+
+
+    for (i = 0; hashes[i].name != NULL; i ++)
+	if (strcmp(hashes[i].name, name) == 0)
+	    return hashes[i].hash;
+
+    return NULL;
+}
+
+
+/*
+ * Function:    reportHash
+ *
+ * Description: Print to FP how HASH spreads the N distinct strings in KEYS
+ *              over a table of LENGTH slots.  The chi-square statistic of
+ *              the slot counts is printed along with how many standard
+ *              deviations it is from what a random hash would give, then
+ *              the longest and average probe that linear probing would
+ *              need to insert every string.
+ */
+
+void reportHash(FILE *fp, char **keys, int n, int length,
+	unsigned (*hash)())
+{
+    int i, locn, probes, longest, *counts;
+    double expected, chisq, total;
+    char *filled;
+
+
+    counts = calloc(length, sizeof(int));
+    filled = calloc(length, sizeof(char));
+
+    if (counts == NULL || filled == NULL || n >= length) {
+	fprintf(fp, "cannot report on %d keys in %d slots\n", n, length);
+	free(counts);
+	free(filled);
+	return;
+    }
+
+    longest = 0;
+    total = 0;
+
+    for (i = 0; i < n; i ++) {
+	locn = (*hash)(keys[i]) % length;
+	counts[locn] ++;
+
+	for (probes = 1; filled[locn]; probes ++)
+	    locn = (locn + 1) % length;
+
+	filled[locn] = 1;
+	total += probes;
+
+	if (probes > longest)
+	    longest = probes;
+    }
+
+    expected = (double) n / length;
+    chisq = 0;
+
+    for (i = 0; i < length; i ++)
+	chisq += (counts[i] - expected) * (counts[i] - expected) / expected;
+
+    fprintf(fp, "%d keys in %d slots\n", n, length);
+    fprintf(fp, "chi-square %.1f on %d degrees of freedom (%+.1f sd)\n",
+	chisq, length - 1, (chisq - (length - 1)) / sqrt(2.0 * (length - 1)));
+    fprintf(fp, "longest probe %d, average probe %.2f\n", longest,
+	n > 0 ? total / n : 0.0);
+
+    free(filled);
+    free(counts);
+}
@@ -0,0 +1,32 @@
+/*
+ * File:        hash.h
+ *
+ * Author:      Riley Heike
+ *
+ * Description: This file contains the public function declarations for a
+ *              collection of string hash functions that the drivers can
+ *              choose between by name, along with a report on how evenly
+ *              a hash function spreads a given set of strings.
+ */
+
+# ifndef HASH_H
+# define HASH_H
+
+# include <stdio.h>
+
+unsigned strhash(char *s);
+
+unsigned fnvhash(char *s);
+
+unsigned wordhash(char *s);
+
+unsigned siphash(char *s);
+
+void setHashSeed(unsigned long seed);
+
+unsigned (*findHash(char *name))();
+
+void reportHash(FILE *fp, char **keys, int n, int length,
+	unsigned (*hash)());
+
+# endif /* HASH_H */
@@ -0,0 +1,184 @@
+/*
+ * File:        lfbench.c
+ *
+ * Author:      Riley Heike
+ *
+ * Description: This file contains the main function for measuring the
+ *              throughput of a set abstract data type for strings shared
+ *              between threads.
+ *
+ *              A vocabulary of distinct words is made and half of it added
+ *              to the set.  Then for each number of threads, doubling up to
+ *              the most asked for, every thread performs the same number of
+ *              operations on random words: a lookup with the given
+ *              probability and otherwise a toggle, which adds the word if it
+ *              is absent and removes it if it is present.  The total number
+ *              of operations per second is printed for each number of
+ *              threads.
+ *
+ *              Built with lftable.c as lfbench, the set is shared as it
+ *              is.  Built with table.c and -DLOCKED as mtbench, every
+ *              operation holds one mutex, which is the baseline the
+ *              lock-free set is measured against.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <pthread.h>
+# include <time.h>
+# include "set.h"
+# include "hash.h"
+
+# define MAX_THREADS 64
+
+# ifdef LOCKED
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+# define LOCK()		pthread_mutex_lock(&lock)
+# define UNLOCK()	pthread_mutex_unlock(&lock)
+# else
+# define LOCK()		((void) 0)
+# define UNLOCK()	((void) 0)
+# endif
+
+static SET *sp;
+static char **words;
+static int vocab, nops;
+static double reads;
+
+
+/*
+ * Function:    worker
+ *
+ * Description: Perform the operations of one thread.
+ */
+
+static void *worker(void *arg)
+{
+    unsigned seed = (long) arg + 1;
+    char *word;
+    int i;
+
+
+    for (i = 0; i < nops; i ++) {
+	word = words[rand_r(&seed) % vocab];
+
+	if (rand_r(&seed) < reads * RAND_MAX) {
+	    LOCK();
+	    findElement(sp, word);
+	    UNLOCK();
+
+	} else {
+	    LOCK();
+	    toggleElement(sp, word);
+	    UNLOCK();
+	}
+    }
+
+    return NULL;
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    pthread_t tids[MAX_THREADS];
+    struct timespec start, stop;
+    char buffer[32];
+    int i, maxThreads;
+    long t, n;
+    double seconds;
+
+
+    /* Check usage. */
+
+    maxThreads = 8;
+    vocab = 100000;
+    nops = 1000000;
+    reads = 0.9;
+
+    while (argc > 2 && argv[1][0] == '-') {
+	if (strcmp(argv[1], "-t") == 0)
+	    maxThreads = atoi(argv[2]);
+	else if (strcmp(argv[1], "-v") == 0)
+	    vocab = atoi(argv[2]);
+	else if (strcmp(argv[1], "-n") == 0)
+	    nops = atoi(argv[2]);
+	else if (strcmp(argv[1], "-r") == 0)
+	    reads = atof(argv[2]);
+	else
+	    break;
+
+	argc -= 2;
+
+	for (i = 1; i < argc; i ++)
+	    argv[i] = argv[i + 2];
+    }
+
+    if (argc != 1 || maxThreads < 1 || maxThreads > MAX_THREADS || vocab < 1
+	|| nops < 1 || reads < 0 || reads > 1) {
+	fprintf(stderr, "usage: %s [-t threads] [-v vocabulary] "
+	    "[-n operations] [-r reads]\n", argv[0]);
+	exit(EXIT_FAILURE);
+    }
+
+
+    /* Make the vocabulary and add half of it. */
+
+    words = malloc(sizeof(char *) * vocab);
+
+    if (words == NULL) {
+	fprintf(stderr, "out of memory\n");
+	exit(EXIT_FAILURE);
+    }
+
+    for (i = 0; i < vocab; i ++) {
+	sprintf(buffer, "word%d", i);
+
+	if ((words[i] = strdup(buffer)) == NULL) {
+	    fprintf(stderr, "out of memory\n");
+	    exit(EXIT_FAILURE);
+	}
+    }
+
+    setHashSeed(1);
+    sp = createSet(vocab * 2, strcmp, strhash);
+
+    for (i = 0; i < vocab; i += 2)
+	addElement(sp, words[i]);
+
+
+    /* Run the operations with each number of threads. */
+
+    printf("%d operations per thread, %d words, %g reads\n", nops, vocab,
+	reads);
+    printf("%7s %15s\n", "threads", "operations/s");
+
+    for (n = 1; n <= maxThreads; n *= 2) {
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	for (t = 0; t < n; t ++)
+	    pthread_create(&tids[t], NULL, worker, (void *) t);
+
+	for (t = 0; t < n; t ++)
+	    pthread_join(tids[t], NULL);
+
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+	seconds = stop.tv_sec - start.tv_sec +
+	    (stop.tv_nsec - start.tv_nsec) / 1e9;
+	printf("%7ld %15.0f\n", n, n * nops / seconds);
+    }
+
+    destroySet(sp);
+
+    for (i = 0; i < vocab; i ++)
+	free(words[i]);
+
+    free(words);
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,335 @@
+/*
+ * File:        lfstress.c
+ *
+ * Author:      Riley Heike
+ *
+ * Description: This file contains the main function for stress testing
+ *              the lock-free set abstract data type in lftable.c.
+ *
+ *              Several threads toggle keys drawn from a small pool, so
+ *              that equal keys are added and removed by different threads
+ *              at once, while the set has only twice as many slots as
+ *              keys.  Every thread has its own copy of each key, so which
+ *              copy the set holds shows which thread added it.  A thread
+ *              counts, for each key, how many of its toggles added the key,
+ *              and from the totals each key must be in the set exactly when
+ *              it was added once more than it was removed.  The set is then
+ *              emptied and every thread adds every key, and exactly one add
+ *              of each key must succeed.  Other threads look keys up the
+ *              whole time and check that any key found is the one looked
+ *              for.  The program prints what failed, if anything, and exits
+ *              with a failure status if anything did.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <stdbool.h>
+# include <pthread.h>
+# include <stdatomic.h>
+# include "set.h"
+
+# define MAX_THREADS 64
+
+struct key {
+    int value;
+};
+
+static SET *sp;
+static int nkeys, nops, nthreads;
+static struct key **copies;
+static atomic_int *adds, *wins;
+static atomic_bool done;
+static atomic_int failures;
+
+
+/*
+ * Function:    compareKeys
+ *
+ * Description: Compare two keys by value.
+ */
+
+static int compareKeys(struct key *k1, struct key *k2)
+{
+    return (k1->value > k2->value) - (k1->value < k2->value);
+}
+
+
+/*
+ * Function:    hashKey
+ *
+ * Description: Return a hash value for a key.  Runs of keys share a
+ *              hash, so equal hashes with unequal keys are tested too.
+ */
+
+static unsigned hashKey(struct key *kp)
+{
+    return (kp->value / 4) * 2654435761u;
+}
+
+
+/*
+ * Function:    fail
+ *
+ * Description: Report a failure with message MSG.
+ */
+
+static void fail(char *msg)
+{
+    fprintf(stderr, "lfstress: %s\n", msg);
+    atomic_fetch_add(&failures, 1);
+}
+
+
+/*
+ * Function:    toggler
+ *
+ * Description: Toggle random keys, counting the adds of each key.
+ */
+
+static void *toggler(void *arg)
+{
+    int t = (long) arg, i, k;
+    unsigned seed = t + 1;
+    struct key *kp;
+
+
+    for (i = 0; i < nops; i ++) {
+	k = rand_r(&seed) % nkeys;
+	kp = toggleElement(sp, &copies[t][k]);
+
+	if (kp == NULL)
+	    atomic_fetch_add(&adds[k], 1);
+	else if (kp->value != k)
+	    fail("toggle removed the wrong key");
+	else
+	    atomic_fetch_sub(&adds[k], 1);
+    }
+
+    return NULL;
+}
+
+
+/*
+ * Function:    adder
+ *
+ * Description: Add every key, starting at a different key in each
+ *              thread, and count the adds that succeed.
+ */
+
+static void *adder(void *arg)
+{
+    int t = (long) arg, i, k;
+    struct key *kp;
+    bool inserted;
+
+
+    for (i = 0; i < nkeys; i ++) {
+	k = (i + t * nkeys / nthreads) % nkeys;
+	kp = findOrAddElement(sp, &copies[t][k], &inserted);
+
+	if (kp->value != k || inserted != (kp == &copies[t][k]))
+	    fail("add returned the wrong key");
+
+	if (inserted)
+	    atomic_fetch_add(&wins[k], 1);
+    }
+
+    return NULL;
+}
+
+
+/*
+ * Function:    reader
+ *
+ * Description: Look up random keys until told to stop.
+ */
+
+static void *reader(void *arg)
+{
+    unsigned seed = (long) arg;
+    struct key key, *kp;
+
+
+    while (!atomic_load(&done)) {
+	key.value = rand_r(&seed) % nkeys;
+	kp = findElement(sp, &key);
+
+	if (kp != NULL && kp->value != key.value)
+	    fail("lookup found the wrong key");
+    }
+
+    return NULL;
+}
+
+
+/*
+ * Function:    run
+ *
+ * Description: Run FN in each of the threads, along with a reader, and
+ *              wait for them all.
+ */
+
+static void run(void *(*fn)(void *))
+{
+    pthread_t tids[MAX_THREADS], rtid;
+    long t;
+
+
+    atomic_store(&done, false);
+    pthread_create(&rtid, NULL, reader, (void *) 1L);
+
+    for (t = 0; t < nthreads; t ++)
+	pthread_create(&tids[t], NULL, fn, (void *) t);
+
+    for (t = 0; t < nthreads; t ++)
+	pthread_join(tids[t], NULL);
+
+    atomic_store(&done, true);
+    pthread_join(rtid, NULL);
+}
+
+
+/*
+ * Function:    checkSet
+ *
+ * Description: Check that the set holds each key at most once and
+ *              exactly the keys whose flag in PRESENT is set.
+ */
+
+static void checkSet(bool *present)
+{
+    struct key **elts;
+    bool *seen;
+    int i, n;
+
+
+    n = numElements(sp);
+    elts = n > 0 ? getElements(sp) : NULL;
+    seen = calloc(nkeys, sizeof(bool));
+
+    for (i = 0; i < n; i ++) {
+	if (seen[elts[i]->value])
+	    fail("set holds a key twice");
+
+	seen[elts[i]->value] = true;
+    }
+
+    for (i = 0; i < nkeys; i ++)
+	if (seen[i] != present[i]) {
+	    fail("set membership does not match the toggles");
+	    break;
+	}
+
+    free(seen);
+    free(elts);
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the stress test.
+ */
+
+int main(int argc, char *argv[])
+{
+    bool *present;
+    int i, t;
+
+
+    /* Check usage. */
+
+    nthreads = 8;
+    nkeys = 1000;
+    nops = 200000;
+
+    while (argc > 2 && argv[1][0] == '-') {
+	if (strcmp(argv[1], "-t") == 0)
+	    nthreads = atoi(argv[2]);
+	else if (strcmp(argv[1], "-k") == 0)
+	    nkeys = atoi(argv[2]);
+	else if (strcmp(argv[1], "-n") == 0)
+	    nops = atoi(argv[2]);
+	else
+	    break;
+
+	argc -= 2;
+
+	for (i = 1; i < argc; i ++)
+	    argv[i] = argv[i + 2];
+    }
+
+    if (argc != 1 || nthreads < 1 || nthreads > MAX_THREADS || nkeys < 1
+	|| nops < 0) {
+	fprintf(stderr, "usage: %s [-t threads] [-k keys] [-n toggles]\n",
+	    argv[0]);
+	exit(EXIT_FAILURE);
+    }
+
+
+    /* Make a copy of every key for each thread. */
+
+    copies = malloc(sizeof(struct key *) * nthreads);
+    adds = calloc(nkeys, sizeof(atomic_int));
+    wins = calloc(nkeys, sizeof(atomic_int));
+    present = malloc(sizeof(bool) * nkeys);
+
+    for (t = 0; t < nthreads; t ++) {
+	copies[t] = malloc(sizeof(struct key) * nkeys);
+
+	for (i = 0; i < nkeys; i ++)
+	    copies[t][i].value = i;
+    }
+
+
+    /* Toggle keys in a set with room for only twice as many. */
+
+    sp = createSet(nkeys * 2, compareKeys, hashKey);
+    run(toggler);
+
+    for (i = 0; i < nkeys; i ++) {
+	if (adds[i] != 0 && adds[i] != 1)
+	    fail("a key was added twice without a remove");
+
+	present[i] = adds[i] == 1;
+    }
+
+    checkSet(present);
+
+
+    /* Empty the set, then add every key from every thread. */
+
+    for (i = 0; i < nkeys; i ++)
+	removeElement(sp, &copies[0][i]);
+
+    if (numElements(sp) != 0)
+	fail("set is not empty after removing every key");
+
+    run(adder);
+
+    for (i = 0; i < nkeys; i ++) {
+	if (wins[i] != 1)
+	    fail("a key was not added exactly once");
+
+	present[i] = true;
+    }
+
+    checkSet(present);
+    destroySet(sp);
+
+    for (t = 0; t < nthreads; t ++)
+	free(copies[t]);
+
+    free(copies);
+    free(adds);
+    free(wins);
+    free(present);
+
+    if (failures > 0)
+	exit(EXIT_FAILURE);
+
+    printf("lfstress: %d threads, %d keys, %d toggles each: all checks passed\n",
+	nthreads, nkeys, nops);
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,902 @@
+#include "set.h"
+#include "tableutil.h"
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <unistd.h>
+
+/* Lock-free version of table.c for sets that are shared
+ * between threads and mostly read. Each slot is a single
+ * atomic pointer: NULL for an empty slot, DELETED for a
+ * deleted one, and the element otherwise. An element is
+ * deleted by a compare-and-swap from the element to DELETED,
+ * and looking up or removing an element never takes a lock,
+ * so a reader never waits on a writer.
+ *
+ * Adding an element that is not already there reuses the
+ * first deleted slot on its probe path. Two threads adding
+ * equal elements could then land in different deleted
+ * slots, so such an add holds one of NLOCKS mutexes, picked
+ * by the element's hash, which every equal element shares.
+ * Adds of elements with different hashes still run side by
+ * side, and claim their slots with a compare-and-swap from
+ * NULL or DELETED. A removed element must not be deallocated
+ * while other threads may still be comparing against it.
+ */
+
+static char tombstone;
+
+#define DELETED ((void *) &tombstone)
+
+#define BLOCK_SIZE 4096
+#define PARALLEL_SIZE 65536
+#define MAX_THREADS 64
+#define NLOCKS 64
+
+/* Counters are shared by every thread, so they are
+ * bumped with relaxed atomic adds when they are kept */
+
+#ifdef SETSTATS
+#undef COUNT
+#define COUNT(x) __atomic_fetch_add(&(x), 1, __ATOMIC_RELAXED)
+#endif
+
+/* Copies made by internElement are carved out of a list
+ * of blocks. Space is claimed from the newest block with an
+ * atomic add, and a full block is replaced by pushing a new
+ * one with a compare-and-swap, so interning never locks */
+
+struct block{
+
+	struct block *next;
+	size_t size;
+	atomic_size_t used;
+	max_align_t data[];
+
+};
+
+/* A range of slots walked by one thread of a set operation.
+ * Each live element of sp in the range is looked up in other,
+ * if there is one, and kept if whether it was found matches
+ * keep. A kept element is added to dst, or its equal element
+ * in other if theirs is set, or removed from dst if drop is
+ * set. If dst is NULL the set is being changed in place, and
+ * elements not kept are deleted */
+
+struct range{
+
+	SET *sp;
+	SET *other;
+	SET *dst;
+	bool keep;
+	bool theirs;
+	bool drop;
+	int lo, hi;
+	pthread_t tid;
+
+};
+
+struct set{
+
+	_Atomic(void *) *elts;
+	int length;
+	atomic_int count;
+	pthread_mutex_t locks[NLOCKS];
+	_Atomic(struct block *) arena;
+	int (*compare)();
+	unsigned (*hash)();
+#ifdef SETSTATS
+	struct setstats stats;
+#endif
+
+};
+
+
+/* Search
+ *
+ * Complexity:
+ * 	Worst Case: O(n)
+ * 	Average Case: O(1)
+ *
+ * Description: Searches for element passed into function,
+ * whose hash is key, and returns its index, or -1 if it was
+ * not found. Stops at the first empty slot, and never probes
+ * more than the length of the table, so it is wait-free. The
+ * element found is stored in the address passed in as match
+ *
+ */
+
+static int search(SET *sp, void *elt, unsigned key, void **match){
+
+	assert(elt);
+	void *cur;
+	int loc;
+
+	int i;
+	for(i = 0; i < sp->length; i++){
+		loc = (i+key) % sp->length;
+		cur = atomic_load(&sp->elts[loc]);
+
+		if(cur == NULL){
+			RECORD(sp->stats.probes, i+1);
+			return -1;
+		}
+
+		if(cur != DELETED && COMPARE(sp, cur, elt) == 0){
+			RECORD(sp->stats.probes, i+1);
+			*match = cur;
+			return loc;
+		}
+
+	}
+
+	RECORD(sp->stats.probes, sp->length);
+	return -1;
+
+}
+
+/* Allocate
+ *
+ * Complexity: O(1) average case
+ *
+ * Description: Returns size bytes from the set's arena,
+ * aligned for any type. If the newest block has no room, a
+ * block twice its size is pushed; a thread that loses the
+ * race to push frees its block and tries the winner's
+ *
+ */
+
+static void *allocate(SET *sp, size_t size){
+
+	struct block *cp, *ncp;
+	size_t align = sizeof(max_align_t);
+	size_t offset, csize;
+
+	size = (size + align - 1) / align * align;
+
+	while(1){
+		cp = atomic_load(&sp->arena);
+
+		if(cp != NULL){
+			offset = atomic_fetch_add(&cp->used, size);
+			if(offset + size <= cp->size) return (char *) cp->data + offset;
+		}
+
+		csize = cp ? cp->size * 2 : BLOCK_SIZE;
+		while(csize < size) csize *= 2;
+
+		ncp = malloc(sizeof(struct block) + csize);
+		assert(ncp);
+		ncp->next = cp;
+		ncp->size = csize;
+		atomic_init(&ncp->used, size);
+
+		if(atomic_compare_exchange_strong(&sp->arena, &cp, ncp))
+			return ncp->data;
+
+		free(ncp);
+	}
+
+}
+
+/* Claim
+ *
+ * Complexity:
+ * 	Worst Case: O(n)
+ * 	Average Case: O(1)
+ *
+ * Description: Probes for elt, whose hash is key, up to the
+ * first empty slot. If an equal element is found, it is
+ * stored in match and its index returned. Otherwise elt is
+ * put in the first deleted slot passed, or else the empty
+ * one, and -1 is returned. The caller holds the lock for
+ * key, so no equal element can be added meanwhile; if a
+ * thread adding some other element takes the chosen slot
+ * first, the probe starts over
+ *
+ */
+
+static int claim(SET *sp, void *elt, unsigned key, void **match){
+
+	void *cur;
+	int i, loc, dloc;
+
+	while(1){
+		dloc = -1;
+
+		for(i = 0; i < sp->length; i++){
+			loc = (i+key) % sp->length;
+			cur = atomic_load(&sp->elts[loc]);
+
+			if(cur == NULL) break;
+
+			if(cur == DELETED){
+				if(dloc < 0) dloc = loc;
+			}
+
+			else if(COMPARE(sp, cur, elt) == 0){
+				RECORD(sp->stats.probes, i+1);
+				*match = cur;
+				return loc;
+			}
+		}
+
+		RECORD(sp->stats.probes, i < sp->length ? i+1 : sp->length);
+
+		if(dloc >= 0){
+			loc = dloc;
+			cur = DELETED;
+		}
+
+		else assert(i < sp->length);
+
+		if(atomic_compare_exchange_strong(&sp->elts[loc], &cur, elt)){
+			atomic_fetch_add(&sp->count, 1);
+			return -1;
+		}
+	}
+
+}
+
+/* Create Set
+ *
+ * Complexity: O(n)
+ *
+ * Description: Allocates memory and creates set based
+ * on set struct, returns set pointer
+ *
+ */
+
+SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)()){
+
+	SET *sp;
+	sp = malloc(sizeof(SET));
+	assert(sp);
+	sp->elts = malloc(sizeof(_Atomic(void *)) * maxElts);
+	assert(sp->elts);
+	sp->compare = compare;
+	sp->hash = hash;
+	sp->length = maxElts;
+	atomic_init(&sp->count, 0);
+	atomic_init(&sp->arena, NULL);
+
+	int i;
+	for(i = 0; i < NLOCKS; i++) pthread_mutex_init(&sp->locks[i], NULL);
+#ifdef SETSTATS
+	memset(&sp->stats, 0, sizeof(struct setstats));
+#endif
+
+	for(i = 0; i < sp->length; i++) atomic_init(&sp->elts[i], NULL);
+
+	return sp;
+
+}
+
+/* Destroy Set
+ *
+ * Complexity: O(1)
+ *
+ * Description: Deletes set by freeing all memory associated.
+ * No other thread may be using the set
+ *
+ */
+
+void destroySet(SET *sp){
+
+	assert(sp);
+	free(sp->elts);
+
+	int i;
+	for(i = 0; i < NLOCKS; i++) pthread_mutex_destroy(&sp->locks[i]);
+
+	struct block *cp, *next;
+	for(cp = atomic_load(&sp->arena); cp != NULL; cp = next){
+		next = cp->next;
+		free(cp);
+	}
+
+	free(sp);
+
+}
+
+
+/* Number of Elements
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns number of elements in the set
+ *
+ */
+
+int numElements(SET *sp){
+
+	assert(sp);
+	return atomic_load(&sp->count);
+
+}
+
+
+/* Add Element
+ *
+ * Complexity:
+ * 	Worst Case: O(n)
+ * 	Average Case: O(1)
+ *
+ * Description: Adds the element as in findOrAddElement
+ *
+ */
+
+void addElement(SET *sp, void *elt){
+
+	findOrAddElement(sp, elt, NULL);
+
+}
+
+/* Find Or Add Element
+ *
+ * Complexity:
+ * 	Worst Case: O(n)
+ * 	Average Case: O(1)
+ *
+ * Description: Looks for an equal element without locking
+ * and returns it if there is one. Otherwise takes the lock
+ * for the element's hash and claims a slot, returning the
+ * equal element if another thread added one meanwhile, or
+ * elt if it was added
+ *
+ */
+
+void *findOrAddElement(SET *sp, void *elt, bool *inserted){
+
+	assert(elt && sp);
+	unsigned key = HASH(sp, elt);
+	void *match;
+	bool found;
+
+	if(search(sp, elt, key, &match) != -1){
+		if(inserted) *inserted = false;
+		return match;
+	}
+
+	pthread_mutex_lock(&sp->locks[key % NLOCKS]);
+	found = claim(sp, elt, key, &match) != -1;
+	pthread_mutex_unlock(&sp->locks[key % NLOCKS]);
+
+	if(inserted) *inserted = !found;
+	return found ? match : elt;
+
+}
+
+/* Toggle Element
+ *
+ * Complexity:
+ * 	Worst Case: O(n)
+ * 	Average Case: O(1)
+ *
+ * Description: An equal element that is found without
+ * locking is marked deleted with a compare-and-swap and
+ * returned. If there is none, the lock for the element's
+ * hash is taken and a slot claimed; an equal element added
+ * meanwhile is deleted instead. If another thread deletes
+ * the equal element first, the search is made again.
+ * Returns NULL if elt was added
+ *
+ */
+
+void *toggleElement(SET *sp, void *elt){
+
+	assert(elt && sp);
+	unsigned key = HASH(sp, elt);
+	void *match;
+	int loc;
+
+	while((loc = search(sp, elt, key, &match)) != -1)
+		if(atomic_compare_exchange_strong(&sp->elts[loc], &match, DELETED)){
+			atomic_fetch_sub(&sp->count, 1);
+			return match;
+		}
+
+	pthread_mutex_lock(&sp->locks[key % NLOCKS]);
+	while((loc = claim(sp, elt, key, &match)) != -1 &&
+		!atomic_compare_exchange_strong(&sp->elts[loc], &match, DELETED));
+	pthread_mutex_unlock(&sp->locks[key % NLOCKS]);
+
+	if(loc == -1) return NULL;
+
+	atomic_fetch_sub(&sp->count, 1);
+	return match;
+
+}
+
+/* Remove Element
+ *
+ * Complexity:
+ * 	Worst Case: O(n)
+ * 	Average Case: O(1)
+ *
+ * Description: Utilizes search function to locate index
+ * of element passed in as parameter, and marks it deleted
+ * with a compare-and-swap so that only one of several
+ * threads removing the same element succeeds
+ *
+ */
+
+void removeElement(SET *sp, void *elt){
+
+	assert(sp && elt);
+	void *match;
+	int key = search(sp, elt, HASH(sp, elt), &match);
+
+	if(key != -1 && atomic_compare_exchange_strong(&sp->elts[key], &match, DELETED))
+		atomic_fetch_sub(&sp->count, 1);
+
+}
+
+/* Find Element
+ *
+ * Complexity:
+ * 	Worst Case: O(n)
+ * 	Average Case: O(1)
+ *
+ * Description: Uses search function to search for
+ * element in array, returns element if found and NULL
+ * if not found
+ *
+ */
+
+void *findElement(SET *sp, void *elt){
+
+	assert(sp && elt);
+
+	void *match;
+	if(search(sp, elt, HASH(sp, elt), &match) != -1) return match;
+	return NULL;
+
+}
+
+
+/* Get Elements
+ *
+ * Complexity: O(n)
+ *
+ * Description: Creates an array of the elements in the
+ * set. Elements added or removed by other threads while
+ * this runs may or may not be included, and the array is
+ * sized for the count at the start
+ *
+ */
+
+void *getElements(SET *sp){
+
+	assert(sp);
+	void **elts;
+	void *cur;
+	int size = atomic_load(&sp->count);
+	elts = malloc(sizeof(void*) * size);
+	assert(elts);
+	int eCount = 0;
+
+	int i;
+	for(i = 0; i < sp->length && eCount < size; i++){
+
+		cur = atomic_load(&sp->elts[i]);
+		if(cur != NULL && cur != DELETED) elts[eCount++] = cur;
+
+	}
+
+	return elts;
+
+}
+
+/* Sift Down
+ *
+ * Complexity: O(log n)
+ *
+ * Description: Moves element i of a heap of n elements
+ * down until neither child ranks lower, so that the lowest
+ * ranked element is at the root
+ *
+ */
+
+static void siftDown(void **heap, int i, int n, int (*rank)()){
+
+	int child;
+	void *temp;
+
+	while((child = 2*i + 1) < n){
+
+		if(child+1 < n && (*rank)(heap[child+1], heap[child]) < 0) child++;
+		if((*rank)(heap[child], heap[i]) >= 0) return;
+
+		temp = heap[i];
+		heap[i] = heap[child];
+		heap[child] = temp;
+		i = child;
+
+	}
+
+}
+
+
+/* Select Top K
+ *
+ * Complexity: O(n log k)
+ *
+ * Description: Stores in top the k elements of the set
+ * that rank highest, highest first, and returns how many
+ * were stored, which is fewer than k if the set is smaller.
+ * rank compares two elements like compare does, returning
+ * more than zero if the first ranks higher. top is kept as
+ * a heap whose root is the lowest of the best elements seen
+ * so far, so each element costs at most one comparison and
+ * a sift, and only the k elements chosen are sorted. Elements added or removed
+ * by other threads while this runs may or may not be seen
+ *
+ */
+
+int selectTopK(SET *sp, void **top, int k, int (*rank)()){
+
+	assert(sp && top && rank);
+	void *temp, *cur;
+	int n = 0;
+
+	int i, j;
+	for(i = 0; i < sp->length && k > 0; i++){
+
+		cur = atomic_load(&sp->elts[i]);
+		if(cur == NULL || cur == DELETED) continue;
+
+		if(n < k){
+			top[n++] = cur;
+			if(n == k) for(j = k/2 - 1; j >= 0; j--) siftDown(top, j, k, rank);
+		}
+
+		else if((*rank)(cur, top[0]) > 0){
+			top[0] = cur;
+			siftDown(top, 0, k, rank);
+		}
+
+	}
+
+	if(n < k) for(i = n/2 - 1; i >= 0; i--) siftDown(top, i, n, rank);
+
+	for(i = n-1; i > 0; i--){
+
+		temp = top[0];
+		top[0] = top[i];
+		top[i] = temp;
+		siftDown(top, 0, i, rank);
+
+	}
+
+	return n;
+
+}
+
+
+/* Intern Element
+ *
+ * Complexity:
+ * 	Worst Case: O(n)
+ * 	Average Case: O(1)
+ *
+ * Description: Returns the element equal to elt if it is
+ * already in the set. Otherwise copies size bytes of elt
+ * into the set's arena and adds the copy. If another thread
+ * adds an equal element first, that element is returned and
+ * the copy's space is simply left unused. Copies belong to
+ * the set and are freed all at once by destroySet
+ *
+ */
+
+void *internElement(SET *sp, void *elt, size_t size){
+
+	assert(sp && elt);
+	void *match, *copy;
+
+	if(search(sp, elt, HASH(sp, elt), &match) != -1) return match;
+
+	copy = allocate(sp, size);
+	memcpy(copy, elt, size);
+	return findOrAddElement(sp, copy, NULL);
+
+}
+
+
+/* Find Elements
+ *
+ * Complexity: O(n)
+ *
+ * Description: Searches for each of the n elements passed
+ * in, storing the element found or NULL at the same index
+ * of found. Each lookup is independent, so this is the same
+ * as calling findElement on each element
+ *
+ */
+
+void findElements(SET *sp, void **elts, int n, void **found){
+
+	assert(sp && elts && found);
+
+	int i;
+	for(i = 0; i < n; i++) found[i] = findElement(sp, elts[i]);
+
+}
+
+
+/* Add Elements
+ *
+ * Complexity: O(n)
+ *
+ * Description: Adds each of the n elements passed in. If
+ * found is not NULL, the element in the set afterwards is
+ * stored at the same index of found, which is not the one
+ * passed in if an equal element was already there
+ *
+ */
+
+void addElements(SET *sp, void **elts, int n, void **found){
+
+	assert(sp && elts);
+
+	int i;
+	for(i = 0; i < n; i++){
+		if(found) found[i] = findOrAddElement(sp, elts[i], NULL);
+		else addElement(sp, elts[i]);
+	}
+
+}
+
+
+/* Walk
+ *
+ * Complexity:
+ * 	Worst Case: O(n^2)
+ * 	Average Case: O(n)
+ *
+ * Description: Does the work for one range of slots, as
+ * described for struct range
+ *
+ */
+
+static void *walk(void *arg){
+
+	struct range *rp = arg;
+	SET *sp = rp->sp, *other = rp->other, *dst = rp->dst;
+	void *elt, *match;
+	bool found;
+
+	int i;
+	for(i = rp->lo; i < rp->hi; i++){
+
+		elt = atomic_load(&sp->elts[i]);
+		if(elt == NULL || elt == DELETED) continue;
+		match = NULL;
+
+		if(other != NULL){
+			found = search(other, elt, HASH(other, elt), &match) != -1;
+
+			if(found != rp->keep){
+				if(dst == NULL && atomic_compare_exchange_strong(&sp->elts[i], &elt, DELETED))
+					atomic_fetch_sub(&sp->count, 1);
+				continue;
+			}
+		}
+
+		if(dst != NULL){
+			if(rp->drop) removeElement(dst, elt);
+			else addElement(dst, rp->theirs ? match : elt);
+		}
+
+	}
+
+	return NULL;
+
+}
+
+
+/* Walk Set
+ *
+ * Complexity:
+ * 	Worst Case: O(n^2)
+ * 	Average Case: O(n)
+ *
+ * Description: Walks every slot of sp as described for
+ * struct range. Removing and deleting never lock, and adds
+ * only lock per hash, so large sets are split into one range
+ * per processor and walked by that many threads whatever
+ * the operation
+ *
+ */
+
+static void walkSet(SET *sp, SET *other, SET *dst, bool keep, bool theirs, bool drop){
+
+	struct range ranges[MAX_THREADS];
+	int i, n = 1;
+
+	if(sp->length >= PARALLEL_SIZE){
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		n = cpus < 1 ? 1 : cpus > MAX_THREADS ? MAX_THREADS : cpus;
+	}
+
+	for(i = 0; i < n; i++){
+		ranges[i].sp = sp;
+		ranges[i].other = other;
+		ranges[i].dst = dst;
+		ranges[i].keep = keep;
+		ranges[i].theirs = theirs;
+		ranges[i].drop = drop;
+		ranges[i].lo = (long) sp->length * i / n;
+		ranges[i].hi = (long) sp->length * (i+1) / n;
+
+		if(i > 0 && pthread_create(&ranges[i].tid, NULL, walk, &ranges[i]) != 0){
+			walk(&ranges[i]);
+			ranges[i].lo = -1;
+		}
+	}
+
+	walk(&ranges[0]);
+
+	for(i = 1; i < n; i++)
+		if(ranges[i].lo != -1) pthread_join(ranges[i].tid, NULL);
+
+}
+
+
+/* Union Sets
+ *
+ * Complexity: O(n + m) average case
+ *
+ * Description: Returns a set of the elements in either
+ * sp1 or sp2, keeping sp1's element where both have equal
+ * ones. If inPlace is true sp2's elements are added to sp1,
+ * which must have room for them, and sp1 is returned;
+ * otherwise a new set is returned, with room for both sets
+ * and sp1's compare and hash functions. The elements are
+ * not copied, so they must outlive the result. Neither set
+ * should be changed by other threads while this runs
+ *
+ */
+
+SET *unionSets(SET *sp1, SET *sp2, bool inPlace){
+
+	assert(sp1 && sp2 && sp1 != sp2);
+	SET *dst = sp1;
+
+	if(!inPlace){
+		dst = createSet(sp1->length + sp2->length, sp1->compare, sp1->hash);
+		walkSet(sp1, NULL, dst, true, false, false);
+	}
+
+	walkSet(sp2, NULL, dst, true, false, false);
+	return dst;
+
+}
+
+
+/* Intersect Sets
+ *
+ * Complexity: O(min(n, m)) average case, or O(n) in place
+ *
+ * Description: Returns a set of sp1's elements that have
+ * an equal element in sp2. A new set walks whichever set is
+ * smaller and looks each element up in the other. In place,
+ * sp1's elements missing from sp2 are deleted and sp1 is
+ * returned
+ *
+ */
+
+SET *intersectSets(SET *sp1, SET *sp2, bool inPlace){
+
+	assert(sp1 && sp2 && sp1 != sp2);
+	SET *dst;
+
+	if(inPlace){
+		walkSet(sp1, sp2, NULL, true, false, false);
+		return sp1;
+	}
+
+	if(atomic_load(&sp2->count) < atomic_load(&sp1->count)){
+		dst = createSet(sp2->length, sp1->compare, sp1->hash);
+		walkSet(sp2, sp1, dst, true, true, false);
+	}
+
+	else{
+		dst = createSet(sp1->length, sp1->compare, sp1->hash);
+		walkSet(sp1, sp2, dst, true, false, false);
+	}
+
+	return dst;
+
+}
+
+
+/* Difference Sets
+ *
+ * Complexity: O(n) average case, or O(min(n, m)) in place
+ *
+ * Description: Returns a set of sp1's elements that have
+ * no equal element in sp2. In place, sp1 is returned after
+ * either removing each of sp2's elements from it, if sp2 is
+ * the smaller set, or deleting each of its elements found
+ * in sp2
+ *
+ */
+
+SET *differenceSets(SET *sp1, SET *sp2, bool inPlace){
+
+	assert(sp1 && sp2 && sp1 != sp2);
+	SET *dst;
+
+	if(inPlace && atomic_load(&sp2->count) < atomic_load(&sp1->count)){
+		walkSet(sp2, NULL, sp1, true, false, true);
+		return sp1;
+	}
+
+	if(inPlace){
+		walkSet(sp1, sp2, NULL, false, false, false);
+		return sp1;
+	}
+
+	dst = createSet(sp1->length, sp1->compare, sp1->hash);
+	walkSet(sp1, sp2, dst, false, false, false);
+	return dst;
+
+}
+
+
+/* Get Set Stats
+ *
+ * Complexity: O(n)
+ *
+ * Description: Fills in stats for the set. A run is a
+ * stretch of slots that are not empty, and a tombstone a
+ * deleted slot not yet reused. The numbers
+ * are only exact if no other thread is changing the set
+ *
+ */
+
+void getSetStats(SET *sp, struct setstats *stats){
+
+	assert(sp && stats);
+	memset(stats, 0, sizeof(struct setstats));
+	stats->count = atomic_load(&sp->count);
+	stats->length = sp->length;
+	stats->bytes = sizeof(SET) + sizeof(_Atomic(void *)) * sp->length;
+
+	struct block *cp;
+	for(cp = atomic_load(&sp->arena); cp != NULL; cp = cp->next)
+		stats->bytes += sizeof(struct block) + cp->size;
+
+	void *cur;
+	int i, run = 0;
+	for(i = 0; i < sp->length; i++){
+
+		cur = atomic_load(&sp->elts[i]);
+		if(cur == DELETED) stats->tombstones++;
+
+		if(cur != NULL) run++;
+		else if(run > 0){
+			stats->chains[statBucket(run)]++;
+			run = 0;
+		}
+
+	}
+
+	if(run > 0) stats->chains[statBucket(run)]++;
+
+#ifdef SETSTATS
+	stats->compares = __atomic_load_n(&sp->stats.compares, __ATOMIC_RELAXED);
+	stats->hashes = __atomic_load_n(&sp->stats.hashes, __ATOMIC_RELAXED);
+	for(i = 0; i < STAT_BUCKETS; i++)
+		stats->probes[i] = __atomic_load_n(&sp->stats.probes[i], __ATOMIC_RELAXED);
+#else
+	stats->compares = -1;
+	stats->hashes = -1;
+#endif
+
+}
@@ -0,0 +1,515 @@
+#include "map.h"
+#include "tableutil.h"
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define BATCH_SIZE 16
+
+/* A slot keeps a key's value and hash beside the key, so
+ * the slot's one cache line answers whether the hashes
+ * match and holds the value to change. Only a key whose
+ * hash matches is read, to compare it */
+
+struct slot{
+
+	void *key;
+	long value;
+	unsigned hash;
+	char flag;
+
+};
+
+struct map{
+
+	struct slot *slots;
+	int length;
+	int count;
+	struct chunk *arena;
+	int (*compare)();
+	unsigned (*hash)();
+	size_t (*size)();
+#ifdef SETSTATS
+	struct setstats stats;
+#endif
+
+};
+
+
+/* Search
+ *
+ * Complexity:
+ * 	Worst Case: O(n)
+ * 	Average Case: O(1)
+ *
+ * Description: Returns the slot holding the key equal to
+ * key, whose hash is h, and sets found. If there is none,
+ * returns the slot the key would be added in, which is the
+ * first tombstone passed if there was one
+ *
+ */
+
+static int search(MAP *mp, void *key, unsigned h, bool *found){
+
+	int dloc = -1;
+	int loc;
+
+	int i;
+	for(i = 0; i < mp->length; i++){
+		loc = (i+h) % mp->length;
+
+		if(mp->slots[loc].flag == 'E'){
+			RECORD(mp->stats.probes, i+1);
+			*found = false;
+			return dloc >= 0 ? dloc : loc;
+		}
+
+		else if(mp->slots[loc].flag == 'D'){
+			if(dloc < 0) dloc = loc;
+		}
+
+		else if(mp->slots[loc].hash == h &&
+			COMPARE(mp, mp->slots[loc].key, key) == 0){
+
+			RECORD(mp->stats.probes, i+1);
+			*found = true;
+			return loc;
+
+		}
+	}
+
+	RECORD(mp->stats.probes, mp->length);
+	*found = false;
+	return dloc;
+
+}
+
+
+/* Place
+ *
+ * Complexity: O(1)
+ *
+ * Description: Fills the slot at loc, found empty by a
+ * search, with key, whose hash is h, and a value of zero.
+ * The key is copied into the arena if the map was given a
+ * size function
+ *
+ */
+
+static void place(MAP *mp, int loc, void *key, unsigned h){
+
+	assert(mp->count < mp->length && loc >= 0);
+
+	if(mp->size != NULL){
+		size_t n = (*mp->size)(key);
+		void *copy = arenaAllocate(&mp->arena, n);
+		memcpy(copy, key, n);
+		key = copy;
+	}
+
+	mp->slots[loc].key = key;
+	mp->slots[loc].value = 0;
+	mp->slots[loc].hash = h;
+	mp->slots[loc].flag = 'F';
+	mp->count++;
+
+}
+
+
+/* Create Map
+ *
+ * Complexity: O(n)
+ *
+ * Description: Allocates memory and creates a map whose
+ * slots are all empty, returns map pointer
+ *
+ */
+
+MAP *createMap(int maxKeys, int (*compare)(), unsigned (*hash)(),
+	size_t (*size)()){
+
+	assert(compare && hash && maxKeys > 0);
+
+	MAP *mp;
+	mp = malloc(sizeof(MAP));
+	assert(mp);
+	mp->slots = malloc(sizeof(struct slot) * maxKeys);
+	assert(mp->slots);
+	mp->compare = compare;
+	mp->hash = hash;
+	mp->size = size;
+	mp->length = maxKeys;
+	mp->count = 0;
+	mp->arena = NULL;
+#ifdef SETSTATS
+	memset(&mp->stats, 0, sizeof(struct setstats));
+#endif
+
+	int i;
+	for(i = 0; i < mp->length; i++) mp->slots[i].flag = 'E';
+
+	return mp;
+
+}
+
+
+/* Destroy Map
+ *
+ * Complexity: O(1)
+ *
+ * Description: Deletes map by freeing its slots, every
+ * chunk of copied keys, and then the map itself
+ *
+ */
+
+void destroyMap(MAP *mp){
+
+	assert(mp);
+	destroyArena(mp->arena);
+	free(mp->slots);
+	free(mp);
+
+}
+
+
+/* Number of Keys
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns number of keys in the map
+ *
+ */
+
+int numKeys(MAP *mp){
+
+	assert(mp);
+	return mp->count;
+
+}
+
+
+/* Increment Key
+ *
+ * Complexity:
+ * 	Worst Case: O(n)
+ * 	Average Case: O(1)
+ *
+ * Description: Adds delta to the value in the slot of the
+ * key equal to key, adding key first with a value of zero
+ * if there is none, and returns the new value. The search
+ * stops at the slot that is then changed
+ *
+ */
+
+long incrementKey(MAP *mp, void *key, long delta){
+
+	assert(mp && key);
+	bool found;
+	unsigned h = HASH(mp, key);
+	int loc = search(mp, key, h, &found);
+
+	if(!found) place(mp, loc, key, h);
+	return mp->slots[loc].value += delta;
+
+}
+
+
+/* Increment Keys
+ *
+ * Complexity:
+ * 	Worst Case: O(n^2)
+ * 	Average Case: O(n)
+ *
+ * Description: Adds delta to the value of each of the n
+ * keys passed in, as incrementKey does. Keys are hashed and
+ * their home slots prefetched BATCH_SIZE at a time before
+ * any of them is searched, so their cache misses overlap
+ *
+ */
+
+void incrementKeys(MAP *mp, void **keys, int n, long delta){
+
+	assert(mp && keys);
+	unsigned hs[BATCH_SIZE];
+	bool found;
+	int i, j, m, loc;
+
+	for(i = 0; i < n; i += BATCH_SIZE){
+		m = n - i < BATCH_SIZE ? n - i : BATCH_SIZE;
+
+		for(j = 0; j < m; j++){
+			assert(keys[i+j]);
+			hs[j] = HASH(mp, keys[i+j]);
+			__builtin_prefetch(&mp->slots[hs[j] % mp->length]);
+		}
+
+		for(j = 0; j < m; j++){
+			loc = search(mp, keys[i+j], hs[j], &found);
+			if(!found) place(mp, loc, keys[i+j], hs[j]);
+			mp->slots[loc].value += delta;
+		}
+	}
+
+}
+
+
+/* Set Key
+ *
+ * Complexity:
+ * 	Worst Case: O(n)
+ * 	Average Case: O(1)
+ *
+ * Description: Gives the key equal to key the value passed
+ * in, adding key if there is none
+ *
+ */
+
+void setKey(MAP *mp, void *key, long value){
+
+	assert(mp && key);
+	bool found;
+	unsigned h = HASH(mp, key);
+	int loc = search(mp, key, h, &found);
+
+	if(!found) place(mp, loc, key, h);
+	mp->slots[loc].value = value;
+
+}
+
+
+/* Find Key
+ *
+ * Complexity:
+ * 	Worst Case: O(n)
+ * 	Average Case: O(1)
+ *
+ * Description: Returns whether a key equal to key is in
+ * the map, storing its value in value if it is and value
+ * is not NULL
+ *
+ */
+
+bool findKey(MAP *mp, void *key, long *value){
+
+	assert(mp && key);
+	bool found;
+	int loc = search(mp, key, HASH(mp, key), &found);
+
+	if(found && value != NULL) *value = mp->slots[loc].value;
+	return found;
+
+}
+
+
+/* Remove Key
+ *
+ * Complexity:
+ * 	Worst Case: O(n)
+ * 	Average Case: O(1)
+ *
+ * Description: Marks the slot of the key equal to key, if
+ * there is one, as deleted. A copied key stays in the arena
+ * until the map is destroyed
+ *
+ */
+
+void removeKey(MAP *mp, void *key){
+
+	assert(mp && key);
+	bool found;
+	int loc = search(mp, key, HASH(mp, key), &found);
+
+	if(found){
+		mp->slots[loc].flag = 'D';
+		mp->count--;
+	}
+
+}
+
+
+/* Get Keys
+ *
+ * Complexity: O(n)
+ *
+ * Description: Copies every key in the map to a new array
+ * that is returned
+ *
+ */
+
+void *getKeys(MAP *mp){
+
+	assert(mp);
+	void **keys;
+	int i, n = 0;
+
+	keys = malloc(sizeof(void *) * (mp->count > 0 ? mp->count : 1));
+	assert(keys);
+
+	for(i = 0; i < mp->length; i++)
+		if(mp->slots[i].flag == 'F') keys[n++] = mp->slots[i].key;
+
+	return keys;
+
+}
+
+
+/* Rank
+ *
+ * Complexity: O(1)
+ *
+ * Description: Compares the slots at a and b, returning
+ * more than zero if a has the larger value, or the same
+ * value and the key that compares lower
+ *
+ */
+
+static int rank(MAP *mp, int a, int b){
+
+	if(mp->slots[a].value != mp->slots[b].value)
+		return mp->slots[a].value < mp->slots[b].value ? -1 : 1;
+
+	return COMPARE(mp, mp->slots[b].key, mp->slots[a].key);
+
+}
+
+
+/* Sift Down
+ *
+ * Complexity: O(log n)
+ *
+ * Description: Moves slot index i of a heap of n indices
+ * down until neither child ranks lower, so that the lowest
+ * ranked slot is at the root
+ *
+ */
+
+static void siftDown(MAP *mp, int *heap, int i, int n){
+
+	int child, temp;
+
+	while((child = 2*i + 1) < n){
+
+		if(child+1 < n && rank(mp, heap[child+1], heap[child]) < 0) child++;
+		if(rank(mp, heap[child], heap[i]) >= 0) return;
+
+		temp = heap[i];
+		heap[i] = heap[child];
+		heap[child] = temp;
+		i = child;
+
+	}
+
+}
+
+
+/* Select Top Keys
+ *
+ * Complexity: O(n log k)
+ *
+ * Description: Stores in keys and values the k keys with
+ * the largest values, largest first, and returns how many
+ * were stored. Slot indices are kept in a heap whose root
+ * is the lowest of the best slots seen so far, as in
+ * selectTopK, and only the k chosen are sorted
+ *
+ */
+
+int selectTopKeys(MAP *mp, void **keys, long *values, int k){
+
+	assert(mp && k >= 0);
+	int *heap;
+	int i, n = 0, temp;
+
+	if(k == 0) return 0;
+	heap = malloc(sizeof(int) * k);
+	assert(heap);
+
+	for(i = 0; i < mp->length; i++){
+
+		if(mp->slots[i].flag != 'F') continue;
+
+		if(n < k){
+			heap[n++] = i;
+			if(n == k) for(temp = k/2 - 1; temp >= 0; temp--) siftDown(mp, heap, temp, k);
+		}
+
+		else if(rank(mp, i, heap[0]) > 0){
+			heap[0] = i;
+			siftDown(mp, heap, 0, k);
+		}
+
+	}
+
+	if(n < k) for(i = n/2 - 1; i >= 0; i--) siftDown(mp, heap, i, n);
+
+	for(i = n-1; i > 0; i--){
+
+		temp = heap[0];
+		heap[0] = heap[i];
+		heap[i] = temp;
+		siftDown(mp, heap, 0, i);
+
+	}
+
+	for(i = 0; i < n; i++){
+		if(keys) keys[i] = mp->slots[heap[i]].key;
+		if(values) values[i] = mp->slots[heap[i]].value;
+	}
+
+	free(heap);
+	return n;
+
+}
+
+
+/* For Each Key
+ *
+ * Complexity: O(n)
+ *
+ * Description: Calls fn with each key, its value and ctx
+ *
+ */
+
+void forEachKey(MAP *mp, void (*fn)(), void *ctx){
+
+	assert(mp && fn);
+
+	int i;
+	for(i = 0; i < mp->length; i++)
+		if(mp->slots[i].flag == 'F')
+			(*fn)(mp->slots[i].key, mp->slots[i].value, ctx);
+
+}
+
+
+/* Get Map Stats
+ *
+ * Complexity: O(n)
+ *
+ * Description: Fills in stats for the map, counting runs
+ * of slots that are not empty as its chains
+ *
+ */
+
+void getMapStats(MAP *mp, struct setstats *stats){
+
+	assert(mp && stats);
+	memset(stats, 0, sizeof(struct setstats));
+	stats->count = mp->count;
+	stats->length = mp->length;
+	stats->bytes = sizeof(MAP) + sizeof(struct slot) * mp->length +
+		arenaBytes(mp->arena);
+	countSlots(stats, &mp->slots[0].flag, sizeof(struct slot), mp->length);
+
+#ifdef SETSTATS
+	stats->compares = mp->stats.compares;
+	stats->hashes = mp->stats.hashes;
+	memcpy(stats->probes, mp->stats.probes, sizeof(stats->probes));
+#else
+	stats->compares = -1;
+	stats->hashes = -1;
+#endif
+
+}
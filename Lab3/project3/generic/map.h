@@ -0,0 +1,74 @@
+/*
+ * File:        map.h
+ *
+ * Author:      Riley Heike
+ *
+ * Description: This file contains the public function and type
+ *              declarations for a map abstract data type for generic
+ *              pointer keys.  A map is an unordered collection of distinct
+ *              keys, each with a value that is a long integer.  A key that
+ *              has never been given a value has the value zero, so a map
+ *              can serve as a counting multiset.
+ *
+ *              Each slot of the table holds a key, its hash, and its value
+ *              side by side, so finding a key and changing its value touch
+ *              the same slot, and only the key itself is read besides.
+ */
+
+# ifndef MAP_H
+# define MAP_H
+
+# include <stddef.h>
+# include <stdbool.h>
+# include "set.h"
+
+typedef struct map MAP;
+
+/*
+ * If SIZE is given, the first time a key is added to a map it is copied
+ * into memory owned by the map, SIZE(key) bytes of it, so the caller may
+ * reuse the key afterwards; the copies are freed by destroyMap.  If SIZE
+ * is NULL the map stores the keys it is given, which must outlive it.
+ */
+
+MAP *createMap(int maxKeys, int (*compare)(), unsigned (*hash)(),
+	size_t (*size)());
+
+void destroyMap(MAP *mp);
+
+int numKeys(MAP *mp);
+
+/*
+ * incrementKey adds DELTA to the value of KEY, adding KEY if it is not in
+ * the map, and returns the new value, looking for KEY only once.
+ * incrementKeys does the same for each of N keys, overlapping their
+ * searches.  findKey returns whether KEY is in the map and, if so and
+ * VALUE is given, stores its value there.
+ */
+
+long incrementKey(MAP *mp, void *key, long delta);
+
+void incrementKeys(MAP *mp, void **keys, int n, long delta);
+
+void setKey(MAP *mp, void *key, long value);
+
+bool findKey(MAP *mp, void *key, long *value);
+
+void removeKey(MAP *mp, void *key);
+
+void *getKeys(MAP *mp);
+
+/*
+ * selectTopKeys stores in KEYS and VALUES, if given, the K keys with the
+ * largest values, largest first, with ties going to the key that compares
+ * lower, and returns how many were stored.  forEachKey calls FN with each
+ * key, its value, and CTX in turn.  The map must not be changed meanwhile.
+ */
+
+int selectTopKeys(MAP *mp, void **keys, long *values, int k);
+
+void forEachKey(MAP *mp, void (*fn)(), void *ctx);
+
+void getMapStats(MAP *mp, struct setstats *stats);
+
+# endif /* MAP_H */
@@ -10,12 +10,20 @@
  *              A set is used to maintain a collection of words that occur
  *              an odd number of times.  The counts of total words and
  *              words appearing an odd number of times are printed.
+ *              Each word is toggled with a single search, and a word
+ *              removed is freed at once, so memory is bounded by the
+ *              words in the set rather than by the words read.
  */
 
 # include <stdio.h>
 # include <stdlib.h>
 # include <string.h>
+# include <stdbool.h>
+# include <time.h>
+# include <unistd.h>
 # include "set.h"
+# include "tableutil.h"
+# include "hash.h"
 
 
 /* This is sufficient for the test cases in /scratch/coen12. */
@@ -23,24 +31,6 @@
 # define MAX_SIZE 18000
 
 
-/*
- * Function:    strhash
- *
- * Description: Return a hash value for a string S.
- */
-
-static unsigned strhash(char *s)
-{
-    unsigned hash = 0;
-
-
-    while (*s != '\0')
-        hash = 31 * hash + *s ++;
-
-    return hash;
-}
-
-
 /*
  * Function:    main
  *
@@ -50,15 +40,41 @@ static unsigned strhash(char *s)
 int main(int argc, char *argv[])
 {
     FILE *fp;
-    char buffer[BUFSIZ], *word;
+    char buffer[BUFSIZ], *word, *old;
+    char **elts;
     SET *odd;
-    int words;
+    struct setstats stats;
+    int i, j, words;
+    bool dflag = false, sflag = false;
+    unsigned (*hash)() = strhash;
 
 
     /* Check usage and open the file. */
 
-    if (argc != 2) {
-        fprintf(stderr, "usage: %s file1\n", argv[0]);
+    while (argc > 1 && argv[1][0] == '-') {
+	if (strcmp(argv[1], "-d") == 0) {
+	    dflag = true;
+	    j = 1;
+
+	} else if (strcmp(argv[1], "-s") == 0) {
+	    sflag = true;
+	    j = 1;
+
+	} else if (strcmp(argv[1], "-h") == 0 && argc > 2) {
+	    hash = findHash(argv[2]);
+	    j = 2;
+
+	} else
+	    break;
+
+	argc -= j;
+
+	for (i = 1; i < argc; i ++)
+	    argv[i] = argv[i + j];
+    }
+
+    if (argc != 2 || hash == NULL) {
+        fprintf(stderr, "usage: %s [-s] [-d] [-h hash] file1\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
@@ -71,22 +87,36 @@ int main(int argc, char *argv[])
     /* Insert or delete words to compute their parity. */
 
     words = 0;
-    odd = createSet(MAX_SIZE, strcmp, strhash);
+    setHashSeed(time(NULL) ^ getpid());
+    odd = createSet(MAX_SIZE, strcmp, hash);
 
     while (fscanf(fp, "%s", buffer) == 1) {
         words ++;
 
-        if ((word = findElement(odd, buffer)) != NULL) {
-            removeElement(odd, buffer);
+	word = strdup(buffer);
+
+	if ((old = toggleElement(odd, word)) != NULL) {
+	    free(old);
 	    free(word);
-	} else
-            addElement(odd, strdup(buffer));
+	}
     }
 
     printf("%d total words\n", words);
     printf("%d words occur an odd number of times\n", numElements(odd));
     fclose(fp);
 
+    if (dflag) {
+	elts = getElements(odd);
+	getSetStats(odd, &stats);
+	reportHash(stderr, elts, numElements(odd), stats.length, hash);
+	free(elts);
+    }
+
+    if (sflag) {
+	getSetStats(odd, &stats);
+	printStats(&stats);
+    }
+
     destroySet(odd);
     exit(EXIT_SUCCESS);
 }
@@ -12,8 +12,33 @@
 # ifndef SET_H
 # define SET_H
 
+# include <stddef.h>
+# include <stdbool.h>
+
 typedef struct set SET;
 
+/*
+ * Statistics about a set.  A histogram counts lengths by powers of two:
+ * bucket 0 counts lengths of zero and bucket k counts lengths from
+ * 2^(k-1) to 2^k - 1.  The compare and hash counts and the histogram of
+ * probes are only kept if the set is compiled with -DSETSTATS; otherwise
+ * the counts are -1 and the histogram is empty, and the set does no extra
+ * work.  The other fields are worked out when the statistics are asked for.
+ */
+
+# define STAT_BUCKETS 32
+
+struct setstats {
+    int count;                  /* number of elements                  */
+    int length;                 /* number of slots or buckets          */
+    int tombstones;             /* deleted slots not yet reused        */
+    size_t bytes;               /* bytes allocated by the set          */
+    long compares;              /* calls to the compare function       */
+    long hashes;                /* calls to the hash function          */
+    long probes[STAT_BUCKETS];  /* searches by elements examined       */
+    long chains[STAT_BUCKETS];  /* filled runs or chains by length     */
+};
+
 SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)());
 
 void destroySet(SET *sp);
@@ -22,10 +47,70 @@ int numElements(SET *sp);
 
 void addElement(SET *sp, void *elt);
 
+/*
+ * internElement adds a copy of SIZE bytes of ELT, kept in memory owned by
+ * the set, unless an equal element is there, and returns the element in
+ * the set.  The copies are only freed by destroySet, not when removed, so
+ * it suits sets that mostly grow; a set whose elements come and go should
+ * have its elements allocated and freed by the caller.
+ */
+
+void *internElement(SET *sp, void *elt, size_t size);
+
 void removeElement(SET *sp, void *elt);
 
 void *findElement(SET *sp, void *elt);
 
+void findElements(SET *sp, void **elts, int n, void **found);
+
+void addElements(SET *sp, void **elts, int n, void **found);
+
 void *getElements(SET *sp);
 
+/*
+ * findOrAddElement returns the element equal to ELT, adding ELT if there
+ * was none, and sets *INSERTED, if given, to whether it was added.
+ * toggleElement adds ELT if no equal element is there and returns NULL,
+ * and otherwise removes the equal element and returns it, so the caller
+ * can free it.  Each looks for ELT only once.
+ */
+
+void *findOrAddElement(SET *sp, void *elt, bool *inserted);
+
+void *toggleElement(SET *sp, void *elt);
+
+int selectTopK(SET *sp, void **top, int k, int (*rank)());
+
+SET *unionSets(SET *sp1, SET *sp2, bool inPlace);
+
+SET *intersectSets(SET *sp1, SET *sp2, bool inPlace);
+
+SET *differenceSets(SET *sp1, SET *sp2, bool inPlace);
+
+void getSetStats(SET *sp, struct setstats *stats);
+
+/*
+ * A set that will only be searched from now on can be frozen into a
+ * minimal perfect hash table, which has one slot per hash and finds an
+ * element in one probe.  Elements that share a hash are kept in a list
+ * after the table, which is only searched for an element with that hash,
+ * so freezing always succeeds.  A frozen set cannot be changed, saved, or
+ * frozen again.  Only the table in table.c can be frozen.
+ */
+
+bool freezeSet(SET *sp);
+
+/*
+ * A set can be saved to a file and mapped back in by a later run instead
+ * of being built again.  SIZE gives the number of bytes in an element,
+ * which are copied into the file.  A mapped set can be searched at once
+ * and is read in as it is used, but cannot be changed.  It must be mapped
+ * with the same compare and hash functions, and hash seed, it was saved
+ * with.  Only the table in table.c can be saved and mapped.
+ */
+
+bool saveSet(SET *sp, char *path, size_t (*size)());
+
+SET *mapSet(char *path, int (*compare)(), unsigned (*hash)());
+
 # endif /* SET_H */
@@ -1,21 +1,150 @@
 #include "set.h"
+#include "tableutil.h"
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define BATCH_SIZE 16
+#define PARALLEL_SIZE 65536
+#define MAX_THREADS 64
+#define MAP_MAGIC "SETMAP1"
+#define BUCKET_SIZE 4
+
+/* Slot i of elts holds an element's offset from base. Base
+ * is zero for a set built in memory, whose offsets are then
+ * just the elements' addresses, and the start of the file
+ * for a set mapped by mapSet, so both are read the same way */
+
+#define ELT(sp, i) ((void *) ((uintptr_t) (sp)->base + (uintptr_t) (sp)->elts[i]))
+
+/* A range of slots walked by one thread of a set operation.
+ * Each live element of sp in the range is looked up in other,
+ * if there is one, and kept if whether it was found matches
+ * keep. A kept element is added to dst, or its equal element
+ * in other if theirs is set. If dst is NULL the set is being
+ * changed in place, and elements not kept are deleted */
+
+struct range{
+
+	SET *sp;
+	SET *other;
+	SET *dst;
+	bool keep;
+	bool theirs;
+	int lo, hi;
+	int removed;
+	pthread_t tid;
+
+};
+
+/* A file written by saveSet starts with a header. After it
+ * come the hashes, the flags, the element offsets and then
+ * the elements themselves, each part starting on a multiple
+ * of max_align_t, and each offset counted from the start of
+ * the file. Only empty and full slots are written, so the
+ * file has no tombstones */
+
+struct header{
+
+	char magic[8];
+	uint32_t length;
+	uint32_t count;
+	uint64_t hashes;
+	uint64_t flags;
+	uint64_t elts;
+	uint64_t size;
+
+};
 
 struct set{
 
 	void **elts;
+	unsigned *hashes;
 	int length;
 	int count;
 	char *flags;
+	struct chunk *arena;
+	char *base;
+	size_t mapped;
+	unsigned *seeds;
+	int buckets;
+	int extras;
 	int (*compare)();
 	unsigned (*hash)();
+#ifdef SETSTATS
+	struct setstats stats;
+#endif
 
 };
 
 
+/* Mix
+ *
+ * Complexity: O(1)
+ *
+ * Description: Scrambles the bits of x so that every bit
+ * of the result depends on every bit of x (the finalizer
+ * of MurmurHash3)
+ *
+ */
+
+static uint64_t mix(uint64_t x){
+
+	x ^= x >> 33;
+	x *= 0xff51afd7ed558ccdULL;
+	x ^= x >> 33;
+	x *= 0xc4ceb9fe1a85ec53ULL;
+	x ^= x >> 33;
+	return x;
+
+}
+
+
+/* Spot
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns the slot, out of n, that the mixed
+ * hash m lands in when its bucket has the seed passed in
+ *
+ */
+
+static int spot(uint64_t m, unsigned seed, int n){
+
+	return (uint32_t) mix(m ^ seed * 0x9e3779b97f4a7c15ULL) * (uint64_t) n >> 32;
+
+}
+
+
+/* Slot
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns the slot an element whose hash is
+ * key is in once the set is frozen, unless it shares its
+ * hash and is kept among the extras. The mixed hash picks a
+ * bucket, and the bucket's seed picks the slot
+ *
+ */
+
+static int slot(SET *sp, unsigned key){
+
+	uint64_t m = mix(key);
+	return spot(m, sp->seeds[(uint32_t) (m >> 32) * (uint64_t) sp->buckets >> 32],
+		sp->length - sp->extras);
+
+}
+
+
 /* Search
  *
  * Complexity: 
@@ -25,24 +154,45 @@ struct set{
  * Description: Searches for element passed into function 
  * within set passed into function, modifies address of bool
  * passed into funtion to convey whether it was found or not,
- * returns address of element if found
+ * returns address of element if found. Key is the hash of the
+ * element, and the compare function is only called on slots
+ * whose stored hash matches it. A frozen set has only the
+ * one slot to look at, and its extras if that slot has the
+ * same hash but another element
  *
  */
 
 
-static int search(SET *sp, void *elt, bool *found){
+static int search(SET *sp, void *elt, unsigned key, bool *found){
 
 	assert(elt);
 	int dkey;
 	bool foundD = false;
-	unsigned key = (*sp->hash)(elt);
 	int loc;
 
+	if(sp->seeds != NULL){
+		RECORD(sp->stats.probes, sp->count > 0);
+		if(sp->count == 0) return *found = false;
+		loc = slot(sp, key);
+		if(sp->hashes[loc] != key) return *found = false;
+		if((*found = COMPARE(sp, ELT(sp, loc), elt) == 0)) return loc;
+
+		int i;
+		for(i = sp->length - sp->extras; i < sp->length; i++)
+			if(sp->hashes[i] == key && COMPARE(sp, ELT(sp, i), elt) == 0){
+				*found = true;
+				return i;
+			}
+
+		return loc;
+	}
+
 	int i;
 	for(i = 0; i < sp->length; i++){
 		loc = (i+key) % sp->length;
 	
 		if(sp->flags[loc] == 'E'){
+			RECORD(sp->stats.probes, i+1);
 			*found = false;
 			if(foundD) return dkey;
 			return loc;
@@ -56,8 +206,10 @@ static int search(SET *sp, void *elt, bool *found){
 			
 		}
 
-		else if ((*sp->compare)(sp->elts[loc], elt) == 0){
+		else if (sp->hashes[loc] == key &&
+			COMPARE(sp, ELT(sp, loc), elt) == 0){
 
+			RECORD(sp->stats.probes, i+1);
 			*found = true;
 			return loc;
 	
@@ -65,6 +217,7 @@ static int search(SET *sp, void *elt, bool *found){
 		
 
 	}
+	RECORD(sp->stats.probes, sp->length);
 	*found = false;
 	return dkey;
 
@@ -85,13 +238,24 @@ SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)()){
 	sp = malloc(sizeof(SET));
 	assert(sp);
 	sp->elts = malloc(sizeof(void*) * maxElts);
+	sp->hashes = malloc(sizeof(unsigned) * maxElts);
 	sp->flags = malloc(sizeof(char) * maxElts);
 	assert(sp->elts);
+	assert(sp->hashes);
 	assert(sp->flags);
 	sp->compare = compare;
 	sp->hash = hash;
 	sp->length = maxElts;
 	sp->count = 0;
+	sp->arena = NULL;
+	sp->base = NULL;
+	sp->mapped = 0;
+	sp->seeds = NULL;
+	sp->buckets = 0;
+	sp->extras = 0;
+#ifdef SETSTATS
+	memset(&sp->stats, 0, sizeof(struct setstats));
+#endif
 
 	int i;
 	for(i = 0; i < sp->length; i++) sp->flags[i] = 'E';
@@ -111,8 +275,20 @@ SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)()){
 void destroySet(SET *sp){
 
 	assert(sp);
+
+	if(sp->mapped > 0){
+		munmap(sp->base, sp->mapped);
+		free(sp);
+		return;
+	}
+
 	free(sp->elts);
+	free(sp->hashes);
 	free(sp->flags);
+	free(sp->seeds);
+
+	destroyArena(sp->arena);
+
 	free(sp);
 	
 }
@@ -150,13 +326,17 @@ void addElement(SET *sp, void *elt){
 
 	bool found;
 	int locn;
+	unsigned key;
 
 	assert(elt && sp);
+	assert(sp->mapped == 0 && sp->seeds == NULL);
 	assert(sp->count < sp->length);
-	locn = search(sp, elt, &found);
+	key = HASH(sp, elt);
+	locn = search(sp, elt, key, &found);
 
 	if(!found){
 		sp->elts[locn] = elt;
+		sp->hashes[locn] = key;
 		sp->flags[locn] = 'F';
 		sp->count++;
 
@@ -178,8 +358,9 @@ void addElement(SET *sp, void *elt){
 void removeElement(SET *sp, void *elt){
 
 	assert(sp && elt);
+	assert(sp->mapped == 0 && sp->seeds == NULL);
 	bool found = false;
-	int key = search(sp, elt, &found);
+	int key = search(sp, elt, HASH(sp, elt), &found);
 
 	if(found){
 		sp->flags[key] = 'D';
@@ -188,6 +369,82 @@ void removeElement(SET *sp, void *elt){
 
 }
 
+/* Find Or Add Element
+ *
+ * Complexity:
+ * 	Worst Case: O(n)
+ * 	Average Case: O(1)
+ *
+ * Description: Uses one search to either find the
+ * element or the slot to put it in, which is the first
+ * deleted slot probed if there was one, and returns the
+ * element in the set afterwards
+ *
+ */
+
+void *findOrAddElement(SET *sp, void *elt, bool *inserted){
+
+	bool found;
+	int locn;
+	unsigned key;
+
+	assert(elt && sp);
+	assert(sp->mapped == 0 && sp->seeds == NULL);
+	key = HASH(sp, elt);
+	locn = search(sp, elt, key, &found);
+
+	if(inserted) *inserted = !found;
+
+	if(!found){
+		assert(sp->count < sp->length);
+		sp->elts[locn] = elt;
+		sp->hashes[locn] = key;
+		sp->flags[locn] = 'F';
+		sp->count++;
+	}
+
+	return sp->elts[locn];
+
+}
+
+/* Toggle Element
+ *
+ * Complexity:
+ * 	Worst Case: O(n)
+ * 	Average Case: O(1)
+ *
+ * Description: Uses one search to either remove the
+ * element or add it in the slot the search stopped at.
+ * Returns the element removed, or NULL if elt was added
+ *
+ */
+
+void *toggleElement(SET *sp, void *elt){
+
+	bool found;
+	int locn;
+	unsigned key;
+
+	assert(elt && sp);
+	assert(sp->mapped == 0 && sp->seeds == NULL);
+	key = HASH(sp, elt);
+	locn = search(sp, elt, key, &found);
+
+	if(found){
+		sp->flags[locn] = 'D';
+		sp->count--;
+		return sp->elts[locn];
+	}
+
+	assert(sp->count < sp->length);
+	sp->elts[locn] = elt;
+	sp->hashes[locn] = key;
+	sp->flags[locn] = 'F';
+	sp->count++;
+	return NULL;
+
+}
+
 /* Find Element
  *
  * Complexity:  
@@ -205,8 +462,8 @@ void *findElement(SET *sp, void *elt){
 	assert(sp && elt);
 	
 	bool found = false;
-	int i = search(sp, elt, &found);
-	if(found) return sp->elts[i];
+	int i = search(sp, elt, HASH(sp, elt), &found);
+	if(found) return ELT(sp, i);
 	return NULL;
 
 }
@@ -234,7 +491,7 @@ void *getElements(SET *sp){
 	for(i = 0; i < sp->length; i++){
 
 		if(sp->flags[i] == 'F'){
-			elts[eCount++] = sp->elts[i];
+			elts[eCount++] = ELT(sp, i);
 		}
 	}
 
@@ -242,3 +499,854 @@ void *getElements(SET *sp){
 
 
 }
+
+/* Sift Down
+ *
+ * Complexity: O(log n)
+ *
+ * Description: Moves element i of a heap of n elements
+ * down until neither child ranks lower, so that the lowest
+ * ranked element is at the root
+ *
+ */
+
+static void siftDown(void **heap, int i, int n, int (*rank)()){
+
+	int child;
+	void *temp;
+
+	while((child = 2*i + 1) < n){
+
+		if(child+1 < n && (*rank)(heap[child+1], heap[child]) < 0) child++;
+		if((*rank)(heap[child], heap[i]) >= 0) return;
+
+		temp = heap[i];
+		heap[i] = heap[child];
+		heap[child] = temp;
+		i = child;
+
+	}
+
+}
+
+
+/* Select Top K
+ *
+ * Complexity: O(n log k)
+ *
+ * Description: Stores in top the k elements of the set
+ * that rank highest, highest first, and returns how many
+ * were stored, which is fewer than k if the set is smaller.
+ * rank compares two elements like compare does, returning
+ * more than zero if the first ranks higher. top is kept as
+ * a heap whose root is the lowest of the best elements seen
+ * so far, so each element costs at most one comparison and
+ * a sift, and only the k elements chosen are sorted
+ *
+ */
+
+int selectTopK(SET *sp, void **top, int k, int (*rank)()){
+
+	assert(sp && top && rank);
+	void *temp;
+	int n = 0;
+
+	int i, j;
+	for(i = 0; i < sp->length && k > 0; i++){
+
+		if(sp->flags[i] != 'F') continue;
+
+		if(n < k){
+			top[n++] = ELT(sp, i);
+			if(n == k) for(j = k/2 - 1; j >= 0; j--) siftDown(top, j, k, rank);
+		}
+
+		else if((*rank)(ELT(sp, i), top[0]) > 0){
+			top[0] = ELT(sp, i);
+			siftDown(top, 0, k, rank);
+		}
+
+	}
+
+	if(n < k) for(i = n/2 - 1; i >= 0; i--) siftDown(top, i, n, rank);
+
+	for(i = n-1; i > 0; i--){
+
+		temp = top[0];
+		top[0] = top[i];
+		top[i] = temp;
+		siftDown(top, 0, i, rank);
+
+	}
+
+	return n;
+
+}
+
+
+/* Intern Element
+ *
+ * Complexity:
+ * 	Worst Case: O(n)
+ * 	Average Case: O(1)
+ *
+ * Description: Returns the element equal to elt if it is
+ * already in the set. Otherwise copies size bytes of elt
+ * into the set's arena, adds the copy and returns it. The
+ * copy belongs to the set: it stays put until destroySet
+ * frees the whole arena at once, and is not freed when
+ * removed from the set
+ *
+ */
+
+void *internElement(SET *sp, void *elt, size_t size){
+
+	assert(sp && elt);
+	assert(sp->mapped == 0 && sp->seeds == NULL);
+	bool found;
+	unsigned key = HASH(sp, elt);
+	int locn = search(sp, elt, key, &found);
+
+	if(!found){
+		assert(sp->count < sp->length);
+		void *copy = arenaAllocate(&sp->arena, size);
+		memcpy(copy, elt, size);
+		sp->elts[locn] = copy;
+		sp->hashes[locn] = key;
+		sp->flags[locn] = 'F';
+		sp->count++;
+	}
+
+	return sp->elts[locn];
+
+}
+
+
+/* Prefetch
+ *
+ * Complexity: O(1)
+ *
+ * Description: Asks the processor to start loading the
+ * home slot for the hash key passed in, so the load can
+ * overlap with work on other elements
+ *
+ */
+
+static void prefetch(SET *sp, unsigned key){
+
+	int loc = sp->seeds ? slot(sp, key) : (int) (key % sp->length);
+	__builtin_prefetch(&sp->flags[loc]);
+	__builtin_prefetch(&sp->hashes[loc]);
+	__builtin_prefetch(&sp->elts[loc]);
+
+}
+
+
+/* Find Elements
+ *
+ * Complexity:
+ * 	Worst Case: O(n^2)
+ * 	Average Case: O(n)
+ *
+ * Description: Searches for each of the n elements passed
+ * in, storing the element found or NULL at the same index
+ * of found. Elements are hashed and their home slots
+ * prefetched BATCH_SIZE at a time before any of them is
+ * searched, so their cache misses overlap
+ *
+ */
+
+void findElements(SET *sp, void **elts, int n, void **found){
+
+	assert(sp && elts && found);
+	unsigned keys[BATCH_SIZE];
+	bool present;
+	int i, j, m, loc;
+
+	for(i = 0; i < n; i += BATCH_SIZE){
+		m = n - i < BATCH_SIZE ? n - i : BATCH_SIZE;
+
+		for(j = 0; j < m; j++){
+			keys[j] = HASH(sp, elts[i+j]);
+			prefetch(sp, keys[j]);
+		}
+
+		for(j = 0; j < m; j++){
+			loc = search(sp, elts[i+j], keys[j], &present);
+			found[i+j] = present ? ELT(sp, loc) : NULL;
+		}
+	}
+
+}
+
+
+/* Add Elements
+ *
+ * Complexity:
+ * 	Worst Case: O(n^2)
+ * 	Average Case: O(n)
+ *
+ * Description: Adds each of the n elements passed in,
+ * hashing and prefetching them in batches like findElements.
+ * If found is not NULL, the element in the set afterwards is
+ * stored at the same index of found, which is not the one
+ * passed in if an equal element was already there
+ *
+ */
+
+void addElements(SET *sp, void **elts, int n, void **found){
+
+	assert(sp && elts);
+	assert(sp->mapped == 0 && sp->seeds == NULL);
+	unsigned keys[BATCH_SIZE];
+	bool present;
+	int i, j, m, loc;
+
+	for(i = 0; i < n; i += BATCH_SIZE){
+		m = n - i < BATCH_SIZE ? n - i : BATCH_SIZE;
+
+		for(j = 0; j < m; j++){
+			assert(elts[i+j]);
+			keys[j] = HASH(sp, elts[i+j]);
+			prefetch(sp, keys[j]);
+		}
+
+		for(j = 0; j < m; j++){
+			loc = search(sp, elts[i+j], keys[j], &present);
+
+			if(!present){
+				assert(sp->count < sp->length);
+				sp->elts[loc] = elts[i+j];
+				sp->hashes[loc] = keys[j];
+				sp->flags[loc] = 'F';
+				sp->count++;
+			}
+
+			if(found) found[i+j] = sp->elts[loc];
+		}
+	}
+
+}
+
+
+/* Insert
+ *
+ * Complexity:
+ * 	Worst Case: O(n)
+ * 	Average Case: O(1)
+ *
+ * Description: Adds element whose hash is key unless an
+ * equal element is already in the set
+ *
+ */
+
+static void insert(SET *sp, void *elt, unsigned key){
+
+	bool found;
+	int locn;
+
+	assert(sp->count < sp->length);
+	assert(sp->mapped == 0 && sp->seeds == NULL);
+	locn = search(sp, elt, key, &found);
+
+	if(!found){
+		sp->elts[locn] = elt;
+		sp->hashes[locn] = key;
+		sp->flags[locn] = 'F';
+		sp->count++;
+	}
+
+}
+
+
+/* Walk
+ *
+ * Complexity:
+ * 	Worst Case: O(n^2)
+ * 	Average Case: O(n)
+ *
+ * Description: Does the work for one range of slots, as
+ * described for struct range. When two sets share a hash
+ * function the stored hash of an element is used for the
+ * other set, so nothing is hashed again
+ *
+ */
+
+static void *walk(void *arg){
+
+	struct range *rp = arg;
+	SET *sp = rp->sp, *other = rp->other, *dst = rp->dst;
+	void *elt, *match;
+	unsigned key;
+	bool found;
+	int i, loc;
+
+	for(i = rp->lo; i < rp->hi; i++){
+
+		if(sp->flags[i] != 'F') continue;
+		elt = ELT(sp, i);
+		match = NULL;
+
+		if(other != NULL){
+			key = other->hash == sp->hash ? sp->hashes[i] : HASH(other, elt);
+			loc = search(other, elt, key, &found);
+			if(found) match = ELT(other, loc);
+
+			if(found != rp->keep){
+				if(dst == NULL){
+					sp->flags[i] = 'D';
+					rp->removed++;
+				}
+				continue;
+			}
+		}
+
+		if(dst != NULL){
+			if(rp->theirs) elt = match;
+			insert(dst, elt, dst->hash == sp->hash ? sp->hashes[i] : HASH(dst, elt));
+		}
+
+	}
+
+	return NULL;
+
+}
+
+
+/* Walk Set
+ *
+ * Complexity:
+ * 	Worst Case: O(n^2)
+ * 	Average Case: O(n)
+ *
+ * Description: Walks every slot of sp as described for
+ * struct range. A set changed in place is only written in
+ * the slot being looked at, so large sets are split into
+ * one range per processor and walked by that many threads.
+ * Adding to another set is done by one thread, as is
+ * everything when SETSTATS is defined, since the counters
+ * are not shared safely
+ *
+ */
+
+static void walkSet(SET *sp, SET *other, SET *dst, bool keep, bool theirs){
+
+	struct range ranges[MAX_THREADS];
+	int i, n = 1;
+
+	assert(dst != NULL || (sp->mapped == 0 && sp->seeds == NULL));
+
+#ifndef SETSTATS
+	if(dst == NULL && sp->length >= PARALLEL_SIZE){
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		n = cpus < 1 ? 1 : cpus > MAX_THREADS ? MAX_THREADS : cpus;
+	}
+#endif
+
+	for(i = 0; i < n; i++){
+		ranges[i].sp = sp;
+		ranges[i].other = other;
+		ranges[i].dst = dst;
+		ranges[i].keep = keep;
+		ranges[i].theirs = theirs;
+		ranges[i].lo = (long) sp->length * i / n;
+		ranges[i].hi = (long) sp->length * (i+1) / n;
+		ranges[i].removed = 0;
+
+		if(i > 0 && pthread_create(&ranges[i].tid, NULL, walk, &ranges[i]) != 0){
+			walk(&ranges[i]);
+			ranges[i].lo = -1;
+		}
+	}
+
+	walk(&ranges[0]);
+
+	for(i = 0; i < n; i++){
+		if(i > 0 && ranges[i].lo != -1) pthread_join(ranges[i].tid, NULL);
+		sp->count -= ranges[i].removed;
+	}
+
+}
+
+
+/* Union Sets
+ *
+ * Complexity: O(n + m) average case
+ *
+ * Description: Returns a set of the elements in either
+ * sp1 or sp2, keeping sp1's element where both have equal
+ * ones. If inPlace is true sp2's elements are added to sp1,
+ * which must have room for them, and sp1 is returned;
+ * otherwise a new set is returned, with room for both sets
+ * and sp1's compare and hash functions. The elements are
+ * not copied, so they must outlive the result
+ *
+ */
+
+SET *unionSets(SET *sp1, SET *sp2, bool inPlace){
+
+	assert(sp1 && sp2 && sp1 != sp2);
+	SET *dst = sp1;
+
+	if(!inPlace){
+		dst = createSet(sp1->length + sp2->length, sp1->compare, sp1->hash);
+		walkSet(sp1, NULL, dst, true, false);
+	}
+
+	walkSet(sp2, NULL, dst, true, false);
+	return dst;
+
+}
+
+
+/* Intersect Sets
+ *
+ * Complexity: O(min(n, m)) average case, or O(n) in place
+ *
+ * Description: Returns a set of sp1's elements that have
+ * an equal element in sp2. A new set walks whichever set is
+ * smaller and looks each element up in the other. In place,
+ * sp1's elements missing from sp2 are deleted and sp1 is
+ * returned
+ *
+ */
+
+SET *intersectSets(SET *sp1, SET *sp2, bool inPlace){
+
+	assert(sp1 && sp2 && sp1 != sp2);
+	SET *dst;
+
+	if(inPlace){
+		walkSet(sp1, sp2, NULL, true, false);
+		return sp1;
+	}
+
+	if(sp2->count < sp1->count){
+		dst = createSet(sp2->length, sp1->compare, sp1->hash);
+		walkSet(sp2, sp1, dst, true, true);
+	}
+
+	else{
+		dst = createSet(sp1->length, sp1->compare, sp1->hash);
+		walkSet(sp1, sp2, dst, true, false);
+	}
+
+	return dst;
+
+}
+
+
+/* Difference Sets
+ *
+ * Complexity: O(n) average case, or O(min(n, m)) in place
+ *
+ * Description: Returns a set of sp1's elements that have
+ * no equal element in sp2. In place, sp1 is returned after
+ * either removing each of sp2's elements from it, if sp2 is
+ * the smaller set, or deleting each of its elements found
+ * in sp2
+ *
+ */
+
+SET *differenceSets(SET *sp1, SET *sp2, bool inPlace){
+
+	assert(sp1 && sp2 && sp1 != sp2);
+	SET *dst;
+	bool found;
+	int i, loc;
+
+	if(inPlace && sp2->count < sp1->count){
+		assert(sp1->mapped == 0 && sp1->seeds == NULL);
+		for(i = 0; i < sp2->length; i++){
+			if(sp2->flags[i] != 'F') continue;
+
+			loc = search(sp1, ELT(sp2, i), sp1->hash == sp2->hash ?
+				sp2->hashes[i] : HASH(sp1, ELT(sp2, i)), &found);
+
+			if(found){
+				sp1->flags[loc] = 'D';
+				sp1->count--;
+			}
+		}
+
+		return sp1;
+	}
+
+	if(inPlace){
+		walkSet(sp1, sp2, NULL, false, false);
+		return sp1;
+	}
+
+	dst = createSet(sp1->length, sp1->compare, sp1->hash);
+	walkSet(sp1, sp2, dst, false, false);
+	return dst;
+
+}
+
+
+/* Put
+ *
+ * Complexity: O(n)
+ *
+ * Description: Writes n bytes of data to a file and then
+ * zeros up to the next multiple of max_align_t, adding what
+ * was written to *pos. Returns whether the writes worked
+ *
+ */
+
+static bool put(FILE *fp, void *data, size_t n, size_t *pos){
+
+	static max_align_t zeros;
+	size_t align = sizeof(max_align_t);
+	size_t rest = (align - n % align) % align;
+
+	*pos += n + rest;
+	return fwrite(data, 1, n, fp) == n && fwrite(&zeros, 1, rest, fp) == rest;
+
+}
+
+
+/* Save Set
+ *
+ * Complexity: O(n)
+ *
+ * Description: Writes the set to a file that mapSet can
+ * map back in. size returns the number of bytes in an
+ * element, which are copied into the file, so elements must
+ * not hold pointers. The full slots are placed again by
+ * their stored hashes, leaving out tombstones, and the
+ * elements are written in the order of their new slots.
+ * Returns false, and removes the file, if it could not be
+ * written. A frozen set cannot be saved
+ *
+ */
+
+bool saveSet(SET *sp, char *path, size_t (*size)()){
+
+	assert(sp && path && size && sp->seeds == NULL);
+	struct header h;
+	size_t align = sizeof(max_align_t), pos = 0;
+	unsigned *hashes = malloc(sizeof(unsigned) * sp->length);
+	char *flags = malloc(sizeof(char) * sp->length);
+	uint64_t *offsets = calloc(sp->length, sizeof(uint64_t));
+	int *from = malloc(sizeof(int) * sp->length);
+	FILE *fp;
+	bool ok;
+	int i, j, loc;
+
+	assert(hashes && flags && offsets && from);
+
+	for(i = 0; i < sp->length; i++) flags[i] = 'E';
+
+	for(i = 0; i < sp->length; i++){
+		if(sp->flags[i] != 'F') continue;
+
+		for(j = 0; flags[loc = (j+sp->hashes[i]) % sp->length] != 'E'; j++);
+		hashes[loc] = sp->hashes[i];
+		flags[loc] = 'F';
+		from[loc] = i;
+	}
+
+	memset(&h, 0, sizeof(struct header));
+	memcpy(h.magic, MAP_MAGIC, sizeof(h.magic));
+	h.length = sp->length;
+	h.count = sp->count;
+	h.hashes = (sizeof(struct header) + align - 1) / align * align;
+	h.flags = h.hashes + (sizeof(unsigned) * sp->length + align - 1) / align * align;
+	h.elts = h.flags + (sp->length + align - 1) / align * align;
+	h.size = h.elts + (sizeof(uint64_t) * sp->length + align - 1) / align * align;
+
+	for(i = 0; i < sp->length; i++){
+		if(flags[i] != 'F') continue;
+
+		offsets[i] = h.size;
+		h.size += ((*size)(ELT(sp, from[i])) + align - 1) / align * align;
+	}
+
+	ok = (fp = fopen(path, "wb")) != NULL;
+
+	if(ok){
+		ok = put(fp, &h, sizeof(struct header), &pos) &&
+			put(fp, hashes, sizeof(unsigned) * sp->length, &pos) &&
+			put(fp, flags, sp->length, &pos) &&
+			put(fp, offsets, sizeof(uint64_t) * sp->length, &pos);
+
+		for(i = 0; ok && i < sp->length; i++)
+			if(flags[i] == 'F')
+				ok = put(fp, ELT(sp, from[i]), (*size)(ELT(sp, from[i])), &pos);
+
+		ok = fclose(fp) == 0 && ok && pos == h.size;
+		if(!ok) remove(path);
+	}
+
+	free(hashes);
+	free(flags);
+	free(offsets);
+	free(from);
+	return ok;
+
+}
+
+
+/* Map Set
+ *
+ * Complexity: O(1)
+ *
+ * Description: Maps a file written by saveSet and returns
+ * it as a set, or NULL if it could not be mapped or is not
+ * such a file. Nothing is read or copied: the set's arrays
+ * point into the mapping and pages are read in as lookups
+ * touch them, so the set is ready as soon as this returns.
+ * compare and hash must behave as they did when the set was
+ * saved, seed included; the hash of the first element is
+ * checked to catch the likeliest mistake. The set is read
+ * only, and destroySet unmaps it
+ *
+ */
+
+SET *mapSet(char *path, int (*compare)(), unsigned (*hash)()){
+
+	assert(path && sizeof(void *) == sizeof(uint64_t));
+	struct header *hp;
+	struct stat st;
+	char *base;
+	SET *sp;
+	int fd, i;
+
+	if((fd = open(path, O_RDONLY)) < 0) return NULL;
+
+	if(fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(struct header)){
+		close(fd);
+		return NULL;
+	}
+
+	base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(base == MAP_FAILED) return NULL;
+
+	hp = (struct header *) base;
+	if(memcmp(hp->magic, MAP_MAGIC, sizeof(hp->magic)) != 0 ||
+			hp->size != (uint64_t) st.st_size || hp->count > hp->length ||
+			hp->elts + sizeof(uint64_t) * hp->length > hp->size){
+		munmap(base, st.st_size);
+		return NULL;
+	}
+
+	madvise(base, st.st_size, MADV_RANDOM);
+
+	sp = malloc(sizeof(SET));
+	assert(sp);
+	sp->elts = (void **) (base + hp->elts);
+	sp->hashes = (unsigned *) (base + hp->hashes);
+	sp->flags = base + hp->flags;
+	sp->length = hp->length;
+	sp->count = hp->count;
+	sp->arena = NULL;
+	sp->base = base;
+	sp->mapped = st.st_size;
+	sp->seeds = NULL;
+	sp->buckets = 0;
+	sp->extras = 0;
+	sp->compare = compare;
+	sp->hash = hash;
+#ifdef SETSTATS
+	memset(&sp->stats, 0, sizeof(struct setstats));
+#endif
+
+	for(i = 0; i < sp->length && sp->flags[i] != 'F'; i++);
+
+	if(i < sp->length && HASH(sp, ELT(sp, i)) != sp->hashes[i]){
+		destroySet(sp);
+		return NULL;
+	}
+
+	return sp;
+
+}
+
+
+/* Freeze Set
+ *
+ * Complexity: O(n log n) expected
+ *
+ * Description: Rebuilds the set as a minimal perfect hash
+ * table, using hash and displace (CHD): the elements are
+ * split into buckets of about BUCKET_SIZE by their hashes,
+ * and each bucket, largest first, is given the first seed
+ * that sends all of its elements to slots still free. The
+ * table then has exactly one slot per element, and a search
+ * looks at one slot and calls compare at most once. Only
+ * the stored hashes are used, so nothing is hashed again,
+ * and elements with the same hash would always land in the
+ * same slot: the first of them gets the slot and the rest
+ * are kept as extras after the n slots, which a search
+ * only scans when the slot's element has the hash it wants
+ * but is another element. A frozen set cannot be changed
+ *
+ */
+
+bool freezeSet(SET *sp){
+
+	assert(sp && sp->mapped == 0 && sp->seeds == NULL);
+	int n = sp->count, nb = n / BUCKET_SIZE + 1;
+	uint64_t *mixed = malloc(sizeof(uint64_t) * (n+1));
+	int *from = malloc(sizeof(int) * (n+1));
+	int *spots = malloc(sizeof(int) * (n+1));
+	int *members = malloc(sizeof(int) * (n+1));
+	int *start = calloc(nb+1, sizeof(int));
+	int *fill = calloc(nb+1, sizeof(int));
+	int *order = malloc(sizeof(int) * nb);
+	char *taken = calloc(n+1, sizeof(char));
+	char *extra = calloc(n+1, sizeof(char));
+	unsigned *seeds = calloc(nb, sizeof(unsigned));
+	void **elts;
+	unsigned *hashes;
+	char *flags;
+	unsigned seed;
+	bool fits;
+	int *sizes, b, i, j, k, m, size, most = 0;
+
+	assert(mixed && from && spots && members && start && fill && order && taken && extra && seeds);
+
+	/* Gather the elements and sort them into their buckets */
+
+	for(i = j = 0; i < sp->length; i++){
+		if(sp->flags[i] != 'F') continue;
+		from[j] = i;
+		mixed[j++] = mix(sp->hashes[i]);
+	}
+
+	for(j = 0; j < n; j++) start[((uint32_t) (mixed[j] >> 32) * (uint64_t) nb >> 32) + 1]++;
+	for(b = 0; b < nb; b++) start[b+1] += start[b];
+
+	for(j = 0; j < n; j++){
+		b = (uint32_t) (mixed[j] >> 32) * (uint64_t) nb >> 32;
+		members[start[b] + fill[b]++] = j;
+	}
+
+	/* Equal hashes land in the same slot whatever the seed, so
+	 * all but the first element with a hash are taken out of
+	 * their buckets, leaving m elements to place */
+
+	for(b = i = m = 0; b < nb; b++){
+		for(j = i; j < start[b+1]; j++){
+			for(k = start[b]; k < m && mixed[members[k]] != mixed[members[j]]; k++);
+			if(k < m) extra[members[j]] = 1;
+			else members[m++] = members[j];
+		}
+		i = start[b+1];
+		start[b+1] = m;
+	}
+
+	/* Order the buckets largest first, counting them by size */
+
+	for(b = 0; b < nb; b++)
+		if(start[b+1] - start[b] > most) most = start[b+1] - start[b];
+
+	sizes = calloc(most+1, sizeof(int));
+	assert(sizes);
+
+	for(b = 0; b < nb; b++) sizes[most - (start[b+1] - start[b])]++;
+	for(i = k = 0; i <= most; i++){
+		size = sizes[i];
+		sizes[i] = k;
+		k += size;
+	}
+	for(b = 0; b < nb; b++) order[sizes[most - (start[b+1] - start[b])]++] = b;
+
+	/* Find each bucket a seed that puts its elements in free,
+	 * different slots */
+
+	for(i = 0; i < nb; i++){
+		b = order[i];
+
+		for(seed = 0, fits = false; !fits; seed++){
+			fits = true;
+
+			for(j = start[b]; fits && j < start[b+1]; j++){
+				spots[members[j]] = spot(mixed[members[j]], seed, m);
+				fits = !taken[spots[members[j]]];
+
+				for(k = start[b]; fits && k < j; k++)
+					fits = spots[members[k]] != spots[members[j]];
+			}
+		}
+
+		seeds[b] = seed - 1;
+		for(j = start[b]; j < start[b+1]; j++) taken[spots[members[j]]] = 1;
+	}
+
+	/* Move each element to its slot in tables of m slots, and
+	 * the extras after them */
+
+	elts = malloc(sizeof(void*) * (n+1));
+	hashes = malloc(sizeof(unsigned) * (n+1));
+	flags = malloc(sizeof(char) * (n+1));
+	assert(elts && hashes && flags);
+
+	for(j = 0, k = m; j < n; j++){
+		i = extra[j] ? k++ : spots[j];
+		elts[i] = sp->elts[from[j]];
+		hashes[i] = sp->hashes[from[j]];
+		flags[i] = 'F';
+	}
+
+	free(sp->elts);
+	free(sp->hashes);
+	free(sp->flags);
+	sp->elts = elts;
+	sp->hashes = hashes;
+	sp->flags = flags;
+	sp->length = n;
+	sp->seeds = seeds;
+	sp->buckets = nb;
+	sp->extras = n - m;
+
+	free(mixed);
+	free(from);
+	free(spots);
+	free(members);
+	free(start);
+	free(fill);
+	free(order);
+	free(sizes);
+	free(taken);
+	free(extra);
+	return true;
+
+}
+
+
+/* Get Set Stats
+ *
+ * Complexity: O(n)
+ *
+ * Description: Fills in stats for the set. A run is a
+ * stretch of slots that are not empty, since a search that
+ * starts anywhere in a run probes to its end on a miss. The
+ * bytes include the arena but not elements the caller owns,
+ * or the whole file for a mapped set
+ *
+ */
+
+void getSetStats(SET *sp, struct setstats *stats){
+
+	assert(sp && stats);
+	memset(stats, 0, sizeof(struct setstats));
+	stats->count = sp->count;
+	stats->length = sp->length;
+	stats->bytes = sizeof(SET) + (sp->mapped > 0 ? sp->mapped :
+		(sizeof(void*) + sizeof(unsigned) + 1) * sp->length) +
+		sizeof(unsigned) * sp->buckets + arenaBytes(sp->arena);
+	countSlots(stats, sp->flags, 1, sp->length);
+
+#ifdef SETSTATS
+	stats->compares = sp->stats.compares;
+	stats->hashes = sp->stats.hashes;
+	memcpy(stats->probes, sp->stats.probes, sizeof(stats->probes));
+#else
+	stats->compares = -1;
+	stats->hashes = -1;
+#endif
+
+}
@@ -0,0 +1,172 @@
+#include "tableutil.h"
+#include <stdlib.h>
+#include <assert.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#define CHUNK_SIZE 4096
+
+
+/* Arena Allocate
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns size bytes from the arena, aligned
+ * for any type. Starts a new chunk, twice as large as the
+ * last one, when the current chunk is full
+ *
+ */
+
+void *arenaAllocate(struct chunk **arena, size_t size){
+
+	struct chunk *cp = *arena;
+	size_t align = sizeof(max_align_t);
+	void *mem;
+
+	size = (size + align - 1) / align * align;
+
+	if(cp == NULL || cp->used + size > cp->size){
+		size_t csize = cp ? cp->size * 2 : CHUNK_SIZE;
+		while(csize < size) csize *= 2;
+
+		cp = malloc(sizeof(struct chunk) + csize);
+		assert(cp);
+		cp->next = *arena;
+		cp->size = csize;
+		cp->used = 0;
+		*arena = cp;
+	}
+
+	mem = (char *) cp->data + cp->used;
+	cp->used += size;
+	return mem;
+
+}
+
+
+/* Destroy Arena
+ *
+ * Complexity: O(log n)
+ *
+ * Description: Frees every chunk of the arena, and with
+ * them every copy in it
+ *
+ */
+
+void destroyArena(struct chunk *arena){
+
+	struct chunk *next;
+
+	while(arena != NULL){
+		next = arena->next;
+		free(arena);
+		arena = next;
+	}
+
+}
+
+
+/* Arena Bytes
+ *
+ * Complexity: O(log n)
+ *
+ * Description: Returns the bytes allocated for the arena
+ *
+ */
+
+size_t arenaBytes(struct chunk *arena){
+
+	size_t bytes = 0;
+
+	for(; arena != NULL; arena = arena->next)
+		bytes += sizeof(struct chunk) + arena->size;
+
+	return bytes;
+
+}
+
+
+/* Stat Bucket
+ *
+ * Complexity: O(log n)
+ *
+ * Description: Returns the histogram bucket for a length
+ * n, which is 0 for n = 0 and k for 2^(k-1) <= n < 2^k
+ *
+ */
+
+int statBucket(long n){
+
+	int k = 0;
+	while(n > 0 && k < STAT_BUCKETS-1){
+		n >>= 1;
+		k++;
+	}
+	return k;
+
+}
+
+
+/* Count Slots
+ *
+ * Complexity: O(n)
+ *
+ * Description: Adds the deleted slots to the tombstones in
+ * stats, and each run of slots that are not empty to its
+ * chains. A search that starts anywhere in a run probes to
+ * its end on a miss
+ *
+ */
+
+void countSlots(struct setstats *stats, const char *flags, size_t stride,
+	int length){
+
+	int i, run = 0;
+	for(i = 0; i < length; i++, flags += stride){
+
+		if(*flags == 'D') stats->tombstones++;
+
+		if(*flags != 'E') run++;
+		else if(run > 0){
+			stats->chains[statBucket(run)]++;
+			run = 0;
+		}
+
+	}
+
+	if(run > 0) stats->chains[statBucket(run)]++;
+
+}
+
+
+/* Print Stats
+ *
+ * Complexity: O(1)
+ *
+ * Description: Prints stats on standard error, with a row
+ * for each histogram bucket that counted anything
+ *
+ */
+
+void printStats(struct setstats *stats){
+
+	fprintf(stderr, "%d elements in %d slots, %d tombstones, %lu bytes\n",
+		stats->count, stats->length, stats->tombstones,
+		(unsigned long) stats->bytes);
+
+	if(stats->compares < 0)
+		fprintf(stderr, "compares and probes not counted without SETSTATS\n");
+	else
+		fprintf(stderr, "%ld compares, %ld hashes\n", stats->compares,
+			stats->hashes);
+
+	fprintf(stderr, "%15s %12s %12s\n", "length", "searches", "runs");
+
+	int i;
+	for(i = 0; i < STAT_BUCKETS; i++)
+		if(stats->probes[i] > 0 || stats->chains[i] > 0)
+			fprintf(stderr, "%7ld - %-5ld %12ld %12ld\n",
+				i > 0 ? 1L << (i-1) : 0L, i > 0 ? (1L << i) - 1 : 0L,
+				stats->probes[i], stats->chains[i]);
+
+}
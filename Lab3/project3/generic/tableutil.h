@@ -0,0 +1,74 @@
+/*
+ * File:        tableutil.h
+ *
+ * Author:      Riley Heike
+ *
+ * Description: This file contains the declarations shared by the hash
+ *              tables in table.c, lftable.c, and map.c, which are not part
+ *              of any abstract data type: an arena that holds copies of
+ *              elements or keys, the helpers that keep their statistics,
+ *              and a function for the programs to print them.
+ */
+
+# ifndef TABLEUTIL_H
+# define TABLEUTIL_H
+
+# include <stddef.h>
+# include "set.h"
+
+/*
+ * The counters are only kept if compiled with -DSETSTATS.  A table whose
+ * counters are shared by threads may redefine COUNT, which the other
+ * macros use.  HASH and COMPARE call a table's own functions, counting the
+ * calls, and expect the table to have hash, compare, and stats fields.
+ */
+
+# ifdef SETSTATS
+# define COUNT(x)	((x) ++)
+# define RECORD(h, n)	COUNT((h)[statBucket(n)])
+# else
+# define COUNT(x)	((void) 0)
+# define RECORD(h, n)	((void) 0)
+# endif
+
+# define HASH(tp, x)	(COUNT((tp)->stats.hashes), (*(tp)->hash)(x))
+# define COMPARE(tp, x, y) \
+    (COUNT((tp)->stats.compares), (*(tp)->compare)(x, y))
+
+/*
+ * An arena is a list of chunks, each twice the size of the one before, so
+ * a handful of mallocs hold every copy and the copies sit next to each
+ * other in memory.  An empty arena is a null pointer.  Space is only given
+ * back when the whole arena is destroyed.
+ */
+
+struct chunk {
+    struct chunk *next;         /* chunk allocated before this one     */
+    size_t size;                /* bytes of data in this chunk         */
+    size_t used;                /* bytes of data handed out            */
+    max_align_t data[];         /* the data, aligned for any type      */
+};
+
+void *arenaAllocate(struct chunk **arena, size_t size);
+
+void destroyArena(struct chunk *arena);
+
+size_t arenaBytes(struct chunk *arena);
+
+/*
+ * statBucket returns the histogram bucket for a length N, as described
+ * for struct setstats.  countSlots adds to STATS the tombstones and the
+ * runs of slots that are not empty among LENGTH slots, whose flags are
+ * 'E' for empty, 'D' for deleted, or anything else for filled, and lie
+ * STRIDE bytes apart starting at FLAGS.  printStats prints STATS on
+ * standard error.
+ */
+
+int statBucket(long n);
+
+void countSlots(struct setstats *stats, const char *flags, size_t stride,
+	int length);
+
+void printStats(struct setstats *stats);
+
+# endif /* TABLEUTIL_H */
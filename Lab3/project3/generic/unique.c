@@ -11,14 +11,21 @@
  *              are inserted into the set and the counts of total words and
  *              total words in the set are printed.  If the second file is
  *              given then all words in the second file are deleted from
- *              the set and the count printed.
+ *              the set and the count printed.  The -h option picks the
+ *              hash function by name, and -d reports on standard error
+ *              how evenly it spread the words.  Words are interned in the
+ *              set's own arena, which destroySet frees all at once.
  */
 
 # include <stdio.h>
 # include <stdlib.h>
 # include <string.h>
 # include <stdbool.h>
+# include <time.h>
+# include <unistd.h>
 # include "set.h"
+# include "tableutil.h"
+# include "hash.h"
 
 
 /* This is sufficient for the test cases in /scratch/coen12. */
@@ -26,24 +33,6 @@
 # define MAX_SIZE 18000
 
 
-/*
- * Function:    strhash
- *
- * Description: Return a hash value for a string S.
- */
-
-static unsigned strhash(char *s)
-{
-    unsigned hash = 0;
-
-
-    while (*s != '\0')
-        hash = 31 * hash + *s ++;
-
-    return hash;
-}
-
-
 /*
  * Function:    main
  *
@@ -53,24 +42,45 @@ static unsigned strhash(char *s)
 int main(int argc, char *argv[])
 {
     FILE *fp;
-    char buffer[BUFSIZ], **elts, *word;
+    char buffer[BUFSIZ], **elts;
     SET *unique;
-    int i, words;
-    bool lflag = false;
+    struct setstats stats;
+    int i, j, words;
+    bool lflag = false, dflag = false, sflag = false;
+    unsigned (*hash)() = strhash;
 
 
     /* Check usage and open the first file. */
 
-    if (argc > 1 && strcmp(argv[1], "-l") == 0) {
-	lflag = true;
-	argc --;
+    while (argc > 1 && argv[1][0] == '-') {
+	if (strcmp(argv[1], "-l") == 0) {
+	    lflag = true;
+	    j = 1;
+
+	} else if (strcmp(argv[1], "-s") == 0) {
+	    sflag = true;
+	    j = 1;
+
+	} else if (strcmp(argv[1], "-d") == 0) {
+	    dflag = true;
+	    j = 1;
+
+	} else if (strcmp(argv[1], "-h") == 0 && argc > 2) {
+	    hash = findHash(argv[2]);
+	    j = 2;
+
+	} else
+	    break;
+
+	argc -= j;
 
 	for (i = 1; i < argc; i ++)
-	    argv[i] = argv[i + 1];
+	    argv[i] = argv[i + j];
     }
 
-    if (argc == 1 || argc > 3) {
-        fprintf(stderr, "usage: %s [-l] file1 [file2]\n", argv[0]);
+    if (argc == 1 || argc > 3 || hash == NULL) {
+        fprintf(stderr, "usage: %s [-l] [-s] [-d] [-h hash] file1 [file2]\n",
+	    argv[0]);
         exit(EXIT_FAILURE);
     }
 
@@ -83,12 +93,12 @@ int main(int argc, char *argv[])
     /* Insert all words into the set. */
 
     words = 0;
-    unique = createSet(MAX_SIZE, strcmp, strhash);
+    setHashSeed(time(NULL) ^ getpid());
+    unique = createSet(MAX_SIZE, strcmp, hash);
 
     while (fscanf(fp, "%s", buffer) == 1) {
         words ++;
-	if (!findElement(unique, buffer))
-	    addElement(unique, strdup(buffer));
+	internElement(unique, buffer, strlen(buffer) + 1);
     }
 
     fclose(fp);
@@ -98,6 +108,13 @@ int main(int argc, char *argv[])
 	printf("%d distinct words\n", numElements(unique));
     }
 
+    if (dflag) {
+	elts = getElements(unique);
+	getSetStats(unique, &stats);
+	reportHash(stderr, elts, numElements(unique), stats.length, hash);
+	free(elts);
+    }
+
 
     /* Try to open the second file. */
 
@@ -110,12 +127,8 @@ int main(int argc, char *argv[])
 
         /* Delete all words in the second file. */
 
-        while (fscanf(fp, "%s", buffer) == 1) {
-	    if ((word = findElement(unique, buffer)) != NULL) {
-		removeElement(unique, buffer);
-		free(word);
-	    }
-	}
+        while (fscanf(fp, "%s", buffer) == 1)
+	    removeElement(unique, buffer);
 
 	fclose(fp);
 
@@ -135,6 +148,11 @@ int main(int argc, char *argv[])
 	free(elts);
     }
 
+    if (sflag) {
+	getSetStats(unique, &stats);
+	printStats(&stats);
+    }
+
     destroySet(unique);
     exit(EXIT_SUCCESS);
 }
@@ -11,8 +11,33 @@
 # ifndef SET_H
 # define SET_H
 
+# include <stddef.h>
+# include <stdbool.h>
+
 typedef struct set SET;
 
+/*
+ * Statistics about a set.  A histogram counts lengths by powers of two:
+ * bucket 0 counts lengths of zero and bucket k counts lengths from
+ * 2^(k-1) to 2^k - 1.  The compare and hash counts and the histogram of
+ * probes are only kept if the set is compiled with -DSETSTATS; otherwise
+ * the counts are -1 and the histogram is empty, and the set does no extra
+ * work.  The other fields are worked out when the statistics are asked for.
+ */
+
+# define STAT_BUCKETS 32
+
+struct setstats {
+    int count;                  /* number of elements                  */
+    int length;                 /* number of slots or buckets          */
+    int tombstones;             /* deleted slots not yet reused        */
+    size_t bytes;               /* bytes allocated by the set          */
+    long compares;              /* calls to the compare function       */
+    long hashes;                /* calls to the hash function          */
+    long probes[STAT_BUCKETS];  /* searches by elements examined       */
+    long chains[STAT_BUCKETS];  /* filled runs or chains by length     */
+};
+
 SET *createSet(int maxElts);
 
 void destroySet(SET *sp);
@@ -27,4 +52,19 @@ char *findElement(SET *sp, char *elt);
 
 char **getElements(SET *sp);
 
+/*
+ * findOrAddElement returns the copy of ELT in the set, adding one if there
+ * was none, and sets *INSERTED, if given, to whether it was added.
+ * toggleElement adds ELT if it is missing and removes it if it is there,
+ * returning whether it is now in the set.  Each looks for ELT only once.
+ */
+
+char *findOrAddElement(SET *sp, char *elt, bool *inserted);
+
+bool toggleElement(SET *sp, char *elt);
+
+void compactSet(SET *sp);
+
+void getSetStats(SET *sp, struct setstats *stats);
+
 # endif /* SET_H */
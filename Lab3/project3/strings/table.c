@@ -1,19 +1,31 @@
 #include "set.h"
+#include "stats.h"
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <stdbool.h>
 
+#ifdef SETSTATS
+#define COUNT(x) ((x)++)
+#define RECORD(h, n) ((h)[statBucket(n)]++)
+#else
+#define COUNT(x) ((void) 0)
+#define RECORD(h, n) ((void) 0)
+#endif
+
 struct set{
 
 	char **elts;
 	int length;
 	int count;
+	int deleted;
 	char *flags;
+#ifdef SETSTATS
+	struct setstats stats;
+#endif
 };
 
 
-
 /* String Hash
  *
  * Complexity: O(n) (for string length n)
@@ -26,7 +38,7 @@ struct set{
 unsigned strhash(char *s){
 
 	unsigned hash = 0;
-	while(*s != '\0') hash = 31 * hash * *s ++;
+	while(*s != '\0') hash = 31 * hash + *s ++;
 	return hash;
 
 }
@@ -51,12 +63,14 @@ static int search(SET *sp, char *elt, bool *found){
 	bool foundD = false;
 	unsigned key = strhash(elt);
 	int loc;
+	COUNT(sp->stats.hashes);
 
 	int i;
 	for(i = 0; i < sp->length; i++){
 		loc = (i+key) % sp->length;
 	
 		if(sp->flags[loc] == 'E'){
+			RECORD(sp->stats.probes, i+1);
 			*found = false;
 			if(foundD) return dkey;
 			return loc;
@@ -69,8 +83,9 @@ static int search(SET *sp, char *elt, bool *found){
 			foundD = true;
 		}
 
-		else if (strcmp(sp->elts[loc], elt) == 0){
+		else if (COUNT(sp->stats.compares), strcmp(sp->elts[loc], elt) == 0){
 
+			RECORD(sp->stats.probes, i+1);
 			*found = true;
 			return loc;
 	
@@ -78,11 +93,50 @@ static int search(SET *sp, char *elt, bool *found){
 		
 
 	}
+	RECORD(sp->stats.probes, sp->length);
 	*found = false;
 	return -1;
 
 }
 
+/* Place
+ *
+ * Complexity:
+ * 	Worst Case: O(n)
+ * 	Average Case: O(1)
+ *
+ * Description: Used by compactSet to put a moving element
+ * back into the table. Probes from the element's hash
+ * location past filled slots; if it lands on another moving
+ * element the two are swapped and the displaced element is
+ * placed in turn, until one lands on an empty slot
+ *
+ */
+
+static void place(SET *sp, char *elt){
+
+	int loc;
+	char *temp;
+
+	while(1){
+		loc = strhash(elt) % sp->length;
+		COUNT(sp->stats.hashes);
+		while(sp->flags[loc] == 'F') loc = (loc+1) % sp->length;
+
+		if(sp->flags[loc] == 'E'){
+			sp->elts[loc] = elt;
+			sp->flags[loc] = 'F';
+			return;
+		}
+
+		temp = sp->elts[loc];
+		sp->elts[loc] = elt;
+		sp->flags[loc] = 'F';
+		elt = temp;
+	}
+
+}
+
 /* Create Set
  *
  * Complexity: O(1)
@@ -102,6 +156,10 @@ SET *createSet(int maxElts){
 	assert(sp->elts);
 	sp->length = maxElts;
 	sp->count = 0;
+	sp->deleted = 0;
+#ifdef SETSTATS
+	memset(&sp->stats, 0, sizeof(struct setstats));
+#endif
 
 	int i;
 	for(i = 0; i < sp->length; i++) sp->flags[i] = 'E';
@@ -151,6 +209,49 @@ int numElements(SET *sp){
 }
 
 
+/* Insert At
+ *
+ * Complexity: O(1)
+ *
+ * Description: Puts a copy of elt in the slot at locn,
+ * which search returned for it, and returns the copy
+ *
+ */
+
+static char *insertAt(SET *sp, int locn, char *elt){
+
+	char *copy;
+	copy = strdup(elt);
+	assert(copy);
+	if(sp->flags[locn] == 'D') sp->deleted--;
+	sp->elts[locn] = copy;
+	sp->flags[locn] = 'F';
+	sp->count++;
+	return copy;
+
+}
+
+/* Delete At
+ *
+ * Complexity: O(1) amortized
+ *
+ * Description: Frees the element in the slot at locn and
+ * marks it deleted, compacting the set once a quarter of
+ * the slots are deleted
+ *
+ */
+
+static void deleteAt(SET *sp, int locn){
+
+	free(sp->elts[locn]);
+	sp->flags[locn] = 'D';
+	sp->count--;
+	sp->deleted++;
+
+	if(sp->deleted > sp->length / 4) compactSet(sp);
+
+}
+
 /* Add Element
  *
  * Complexity:
@@ -172,15 +273,7 @@ void addElement(SET *sp, char *elt){
 	assert(sp->count < sp->length);
 	locn = search(sp, elt, &found);
 
-	if(!found){
-		char *copy;
-		copy = strdup(elt);
-		assert(copy);
-		sp->elts[locn] = copy;
-		sp->flags[locn] = 'F';
-		sp->count++;
-
-	}
+	if(!found) insertAt(sp, locn, elt);
 }
 
 /* Remove Element
@@ -200,11 +293,65 @@ void removeElement(SET *sp, char *elt){
 	bool found;
 	int key = search(sp, elt, &found);
 
-	if(found){
-		free(sp->elts[key]);
-		sp->flags[key] = 'D';
-		sp->count--;
+	if(found) deleteAt(sp, key);
+
+}
+
+/* Find Or Add Element
+ *
+ * Complexity:
+ * 	Worst Case: O(n)
+ * 	Average Case: O(1)
+ *
+ * Description: Uses one search to either find the
+ * element or the slot to put it in, which is the first
+ * deleted slot probed if there was one, and returns the
+ * copy in the set
+ *
+ */
+
+char *findOrAddElement(SET *sp, char *elt, bool *inserted){
+
+	bool found = false;
+	int locn;
+
+	assert(elt && sp);
+	locn = search(sp, elt, &found);
+
+	if(inserted) *inserted = !found;
+	if(found) return sp->elts[locn];
+
+	assert(sp->count < sp->length);
+	return insertAt(sp, locn, elt);
+
+}
+
+/* Toggle Element
+ *
+ * Complexity:
+ * 	Worst Case: O(n)
+ * 	Average Case: O(1)
+ *
+ * Description: Uses one search to either remove the
+ * element or add it in the slot the search stopped at,
+ * and returns whether it is now in the set
+ *
+ */
+
+bool toggleElement(SET *sp, char *elt){
+
+	bool found = false;
+	int locn;
+
+	assert(elt && sp);
+	locn = search(sp, elt, &found);
+
+	if(found) deleteAt(sp, locn);
+	else{
+		assert(sp->count < sp->length);
+		insertAt(sp, locn, elt);
 	}
+	return !found;
 
 }
 
@@ -262,3 +409,89 @@ char **getElements(SET *sp){
 
 
 }
+
+
+/* Compact Set
+ *
+ * Complexity: O(n)
+ *
+ * Description: Rehashes the set in place to get rid of
+ * deleted slots, which otherwise make every miss probe
+ * further. Deleted slots are marked empty and filled slots
+ * marked as moving ('M'), then each moving element is placed
+ * again without allocating a second array. Called by
+ * removeElement once a quarter of the slots are deleted,
+ * and can be called between phases of a workload
+ *
+ */
+
+void compactSet(SET *sp){
+
+	assert(sp);
+
+	int i;
+	for(i = 0; i < sp->length; i++){
+
+		if(sp->flags[i] == 'D') sp->flags[i] = 'E';
+		else if(sp->flags[i] == 'F') sp->flags[i] = 'M';
+
+	}
+
+	for(i = 0; i < sp->length; i++){
+
+		if(sp->flags[i] == 'M'){
+			sp->flags[i] = 'E';
+			place(sp, sp->elts[i]);
+		}
+
+	}
+
+	sp->deleted = 0;
+
+}
+
+
+/* Get Set Stats
+ *
+ * Complexity: O(n)
+ *
+ * Description: Fills in stats for the set. A run is a
+ * stretch of slots that are not empty, since a search that
+ * starts anywhere in a run probes to its end on a miss
+ *
+ */
+
+void getSetStats(SET *sp, struct setstats *stats){
+
+	assert(sp && stats);
+	memset(stats, 0, sizeof(struct setstats));
+	stats->count = sp->count;
+	stats->length = sp->length;
+	stats->tombstones = sp->deleted;
+	stats->bytes = sizeof(SET) + (sizeof(char*) + 1) * sp->length;
+
+	int i, run = 0;
+	for(i = 0; i < sp->length; i++){
+
+		if(sp->flags[i] == 'F') stats->bytes += strlen(sp->elts[i]) + 1;
+
+		if(sp->flags[i] != 'E') run++;
+		else if(run > 0){
+			stats->chains[statBucket(run)]++;
+			run = 0;
+		}
+
+	}
+
+	if(run > 0) stats->chains[statBucket(run)]++;
+
+#ifdef SETSTATS
+	stats->compares = sp->stats.compares;
+	stats->hashes = sp->stats.hashes;
+	memcpy(stats->probes, sp->stats.probes, sizeof(stats->probes));
+#else
+	stats->compares = -1;
+	stats->hashes = -1;
+#endif
+
+}
@@ -19,6 +19,7 @@
 # include <string.h>
 # include <stdbool.h>
 # include "set.h"
+# include "stats.h"
 
 
 /* This is sufficient for the test cases in /scratch/coen12. */
@@ -37,14 +38,21 @@ int main(int argc, char *argv[])
     FILE *fp;
     char buffer[BUFSIZ], **elts;
     SET *unique;
+    struct setstats stats;
     int i, words;
-    bool lflag = false;
+    bool lflag = false, sflag = false;
 
 
     /* Check usage and open the first file. */
 
-    if (argc > 1 && strcmp(argv[1], "-l") == 0) {
-	lflag = true;
+    while (argc > 1 && argv[1][0] == '-') {
+	if (strcmp(argv[1], "-l") == 0)
+	    lflag = true;
+	else if (strcmp(argv[1], "-s") == 0)
+	    sflag = true;
+	else
+	    break;
+
 	argc --;
 
 	for (i = 1; i < argc; i ++)
@@ -52,7 +60,7 @@ int main(int argc, char *argv[])
     }
 
     if (argc == 1 || argc > 3) {
-        fprintf(stderr, "usage: %s [-l] file1 [file2]\n", argv[0]);
+        fprintf(stderr, "usage: %s [-l] [-s] file1 [file2]\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
@@ -112,6 +120,11 @@ int main(int argc, char *argv[])
 	free(elts);
     }
 
+    if (sflag) {
+	getSetStats(unique, &stats);
+	printStats(&stats);
+    }
+
     destroySet(unique);
     exit(EXIT_SUCCESS);
 }
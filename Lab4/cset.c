@@ -0,0 +1,519 @@
+/*
+ * File: cset.c
+ *
+ * Name: Riley Heike
+ *
+ * Description: Thread-safe version of the hashed set in
+ * set.c. Buckets are the same lists as in set.c, but each
+ * bucket is guarded by one of a fixed number of mutexes
+ * (bucket i uses lock i % NLOCKS), so threads working on
+ * different buckets rarely wait on each other. The count
+ * is kept in an atomic integer so no global lock is ever
+ * taken. createSet, destroySet, getElements, organizeSet
+ * and a walk with beginSet and nextElement must not run at
+ * the same time as any other operation on the set
+ *
+ */
+
+#include "set.h"
+#include "stats.h"
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "list.h"
+
+#define NLOCKS 64
+
+/* Counters are shared by every thread, so they are
+ * bumped with relaxed atomic adds when they are kept */
+
+#ifdef SETSTATS
+#define COUNT(x) __atomic_fetch_add(&(x), 1, __ATOMIC_RELAXED)
+#define RECORD(h, n) __atomic_fetch_add(&(h)[statBucket(n)], 1, __ATOMIC_RELAXED)
+#else
+#define COUNT(x) ((void) 0)
+#define RECORD(h, n) ((void) 0)
+#endif
+
+#define HASH(sp, elt) (COUNT((sp)->stats.hashes), (*(sp)->hash)(elt))
+
+struct setiter{
+
+	SET *sp;
+	int locn;
+	void *cursor;
+
+};
+
+typedef struct set{
+
+	LIST **elts;
+	int length;
+	atomic_int count;
+	pthread_mutex_t locks[NLOCKS];
+	int (*compare)();
+	unsigned (*hash)();
+	void *(*look)(LIST *, void *);
+	struct setiter iter;
+#ifdef SETSTATS
+	struct setstats stats;
+#endif
+
+}SET;
+
+
+/* Find
+ *
+ * Complexity: O(n)
+ *
+ * Description: Returns the item equal to elt in the list
+ * at locn, or NULL, reordering the list as organizeSet
+ * chose. If counting, records how many items
+ * the list compared against. The caller must hold the
+ * bucket's lock
+ *
+ */
+
+static void *find(SET *sp, int locn, void *elt){
+
+#ifdef SETSTATS
+	long before = numCompares(sp->elts[locn]);
+	void *item = (*sp->look)(sp->elts[locn], elt);
+	RECORD(sp->stats.probes, numCompares(sp->elts[locn]) - before);
+	return item;
+#else
+	return (*sp->look)(sp->elts[locn], elt);
+#endif
+
+}
+
+
+/* Take
+ *
+ * Complexity: O(n)
+ *
+ * Description: Removes the item equal to elt from the list
+ * at locn in one pass, and returns it, or NULL. If
+ * counting, records how many items the list compared
+ * against. The caller must hold the bucket's lock
+ *
+ */
+
+static void *take(SET *sp, int locn, void *elt){
+
+	void *item;
+
+	if(numItems(sp->elts[locn]) == 0){
+		RECORD(sp->stats.probes, 0);
+		return NULL;
+	}
+
+#ifdef SETSTATS
+	long before = numCompares(sp->elts[locn]);
+	item = removeItem(sp->elts[locn], elt);
+	RECORD(sp->stats.probes, numCompares(sp->elts[locn]) - before);
+#else
+	item = removeItem(sp->elts[locn], elt);
+#endif
+
+	if(item != NULL) atomic_fetch_sub(&sp->count, 1);
+	return item;
+
+}
+
+
+/* Create Set
+ *
+ * Complexity: O(n)
+ *
+ * Description: Allocates memory and creates list for each
+ * location in hash table, and initializes the locks
+ *
+ */
+
+SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)()){
+
+	assert((*hash) && (*compare));
+
+	SET *sp;
+	sp = malloc(sizeof(SET));
+	assert(sp);
+	sp->elts = malloc(sizeof(void*) * maxElts);
+	assert(sp->elts);
+	sp->compare = compare;
+	sp->hash = hash;
+	sp->look = findItem;
+	sp->iter.sp = sp;
+	sp->length = maxElts;
+	atomic_init(&sp->count, 0);
+#ifdef SETSTATS
+	memset(&sp->stats, 0, sizeof(struct setstats));
+#endif
+
+	int i;
+	for(i = 0; i < sp->length; i++) sp->elts[i] = createList(sp->compare);
+	for(i = 0; i < NLOCKS; i++) pthread_mutex_init(&sp->locks[i], NULL);
+
+	return sp;
+
+}
+
+/* Destroy Set
+ *
+ * Complexity: O(n)
+ *
+ * Description: Deletes set by freeing each list and lock,
+ * and then entire set
+ *
+ */
+
+void destroySet(SET *sp){
+
+	assert(sp);
+
+	int i;
+	for(i = 0; i < sp->length; i++){
+
+		destroyList(sp->elts[i]);
+
+	}
+
+	for(i = 0; i < NLOCKS; i++) pthread_mutex_destroy(&sp->locks[i]);
+
+	free(sp->elts);
+	free(sp);
+
+}
+
+
+/* Number of Elements
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns number of elements in the set
+ *
+ */
+
+int numElements(SET *sp){
+
+	assert(sp);
+	return atomic_load(&sp->count);
+
+}
+
+
+/* Add Element
+ *
+ * Complexity: O(n)
+ *
+ * Description: Locks the bucket at the hashing key, and
+ * adds element to its list if it is not already there
+ *
+ */
+
+void addElement(SET *sp, void *elt){
+
+	unsigned locn;
+
+	assert(elt && sp);
+	locn = HASH(sp, elt) % sp->length;
+
+	pthread_mutex_lock(&sp->locks[locn % NLOCKS]);
+
+	if(find(sp, locn, elt) == NULL){
+		addFirst(sp->elts[locn], elt);
+		atomic_fetch_add(&sp->count, 1);
+
+	}
+
+	pthread_mutex_unlock(&sp->locks[locn % NLOCKS]);
+}
+
+/* Remove Element
+ *
+ * Complexity: O(n)
+ *
+ * Description: Locks the bucket at the hashing key, and
+ * removes the item from its list if it is there
+ *
+ */
+
+void removeElement(SET *sp, void *elt){
+
+	assert(sp && elt);
+	int key = HASH(sp, elt) % sp->length;
+
+	pthread_mutex_lock(&sp->locks[key % NLOCKS]);
+	take(sp, key, elt);
+	pthread_mutex_unlock(&sp->locks[key % NLOCKS]);
+
+}
+
+/* Find Or Add Element
+ *
+ * Complexity: O(n)
+ *
+ * Description: Locks the bucket at the hashing key, and
+ * adds elt to its list if no equal item is there, so no
+ * other thread can add an equal element in between.
+ * Returns the element in the set afterwards
+ *
+ */
+
+void *findOrAddElement(SET *sp, void *elt, bool *inserted){
+
+	assert(sp && elt);
+	void *item;
+
+	int locn = HASH(sp, elt) % sp->length;
+
+	pthread_mutex_lock(&sp->locks[locn % NLOCKS]);
+
+	item = find(sp, locn, elt);
+	if(item == NULL){
+		addFirst(sp->elts[locn], elt);
+		atomic_fetch_add(&sp->count, 1);
+	}
+
+	pthread_mutex_unlock(&sp->locks[locn % NLOCKS]);
+
+	if(inserted) *inserted = item == NULL;
+	return item != NULL ? item : elt;
+
+}
+
+/* Toggle Element
+ *
+ * Complexity: O(n)
+ *
+ * Description: Locks the bucket at the hashing key, and
+ * removes the item equal to elt from its list, or adds elt
+ * if there was none. Returns the item removed, or NULL if
+ * elt was added
+ *
+ */
+
+void *toggleElement(SET *sp, void *elt){
+
+	assert(sp && elt);
+	void *item;
+
+	int locn = HASH(sp, elt) % sp->length;
+
+	pthread_mutex_lock(&sp->locks[locn % NLOCKS]);
+
+	item = take(sp, locn, elt);
+	if(item == NULL){
+		addFirst(sp->elts[locn], elt);
+		atomic_fetch_add(&sp->count, 1);
+	}
+
+	pthread_mutex_unlock(&sp->locks[locn % NLOCKS]);
+
+	return item;
+
+}
+
+/* Organize Set
+ *
+ * Complexity: O(1)
+ *
+ * Description: Chooses the list function that searches a
+ * bucket: findItem leaves it alone, promoteItem moves a hit
+ * to the front and transposeItem moves it up one place.
+ * Since every search holds its bucket's lock, reordering
+ * is as safe as adding
+ *
+ */
+
+void organizeSet(SET *sp, int policy){
+
+	assert(sp);
+
+	if(policy == SET_MOVE_TO_FRONT) sp->look = promoteItem;
+	else if(policy == SET_TRANSPOSE) sp->look = transposeItem;
+	else{
+		assert(policy == SET_FIXED);
+		sp->look = findItem;
+	}
+
+}
+
+/* Find Element
+ *
+ * Complexity: O(n)
+ *
+ * Description: Locks the bucket at the hashing key and
+ * goes through its list to determine if element exists,
+ * returns the item if found
+ *
+ */
+
+void *findElement(SET *sp, void *elt){
+
+	assert(sp && elt);
+	void *item;
+
+	int i = HASH(sp, elt) % sp->length;
+
+	pthread_mutex_lock(&sp->locks[i % NLOCKS]);
+	item = find(sp, i, elt);
+	pthread_mutex_unlock(&sp->locks[i % NLOCKS]);
+
+	return item;
+
+}
+
+
+/* Get Elements
+ *
+ * Complexity: O(n)
+ *
+ * Description: Copies every element cotained in the set
+ * to a new void pointer that is returned
+ *
+ */
+
+void *getElements(SET *sp){
+
+	assert(sp);
+	void **elts;
+	void *cursor, *elt;
+
+	elts = malloc(sizeof(void *) * atomic_load(&sp->count));
+	assert(elts);
+
+	int index = 0;
+
+	int i;
+	for(i = 0; i < sp->length; i++){
+
+		cursor = NULL;
+		while((elt = nextItem(sp->elts[i], &cursor)) != NULL)
+			elts[index++] = elt;
+
+	}
+
+	return elts;
+}
+
+
+/* Begin Set
+ *
+ * Complexity: O(1)
+ *
+ * Description: Starts the set's iterator over at the
+ * first bucket and returns it. Like getElements, a walk
+ * must not run at the same time as any other operation
+ *
+ */
+
+SETITER *beginSet(SET *sp){
+
+	assert(sp);
+	sp->iter.locn = 0;
+	sp->iter.cursor = NULL;
+	return &sp->iter;
+
+}
+
+
+/* Next Element
+ *
+ * Complexity: O(1) average case
+ *
+ * Description: Returns the next element in the current
+ * bucket's list, moving on to the following buckets when
+ * it runs out, or NULL once every bucket is done
+ *
+ */
+
+void *nextElement(SETITER *it){
+
+	assert(it);
+	void *elt;
+
+	while(it->locn < it->sp->length){
+
+		elt = nextItem(it->sp->elts[it->locn], &it->cursor);
+		if(elt != NULL) return elt;
+
+		it->locn++;
+		it->cursor = NULL;
+
+	}
+
+	return NULL;
+
+}
+
+
+/* For Each Element
+ *
+ * Complexity: O(n)
+ *
+ * Description: Calls fn with each element and ctx. Each
+ * bucket's lock is held while its list is walked, so fn
+ * must not call any other operation on the set
+ *
+ */
+
+void forEachElement(SET *sp, void (*fn)(), void *ctx){
+
+	assert(sp && fn);
+
+	int i;
+	for(i = 0; i < sp->length; i++){
+
+		pthread_mutex_lock(&sp->locks[i % NLOCKS]);
+		forEachItem(sp->elts[i], fn, ctx);
+		pthread_mutex_unlock(&sp->locks[i % NLOCKS]);
+
+	}
+
+}
+
+
+/* Get Set Stats
+ *
+ * Complexity: O(n)
+ *
+ * Description: Fills in stats for the set. Each bucket's
+ * list is a chain, and empty buckets are counted as chains
+ * of length zero. Compares are counted by the lists. Must
+ * not run at the same time as any other operation
+ *
+ */
+
+void getSetStats(SET *sp, struct setstats *stats){
+
+	assert(sp && stats);
+	memset(stats, 0, sizeof(struct setstats));
+	stats->count = atomic_load(&sp->count);
+	stats->length = sp->length;
+	stats->bytes = sizeof(SET) + sizeof(LIST *) * sp->length;
+
+	int i;
+	for(i = 0; i < sp->length; i++){
+
+		stats->bytes += sizeList(sp->elts[i]);
+		stats->chains[statBucket(numItems(sp->elts[i]))]++;
+
+#ifdef SETSTATS
+		stats->compares += numCompares(sp->elts[i]);
+#endif
+
+	}
+
+#ifdef SETSTATS
+	stats->hashes = sp->stats.hashes;
+	memcpy(stats->probes, sp->stats.probes, sizeof(stats->probes));
+#else
+	stats->compares = -1;
+	stats->hashes = -1;
+#endif
+
+}
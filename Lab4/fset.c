@@ -0,0 +1,661 @@
+/*
+ * File: fset.c
+ *
+ * Name: Riley Heike
+ *
+ * Description: Version of the hashed set in set.c whose
+ * buckets are flat arrays instead of lists. A bucket holds
+ * its first INLINE_SIZE elements in the table itself, and
+ * any more in an overflow array of its own that doubles in
+ * size when it fills. Alongside each element is a 16-bit
+ * tag taken from its hash, so searching a bucket is a scan
+ * over at most two runs of contiguous tags, and compare is
+ * only called when a tag matches. An empty bucket is found
+ * to be empty without leaving the table, no element costs a
+ * node of its own and no bucket costs a list and a
+ * sentinel. The order of the elements within a bucket is
+ * not kept: a removed element is replaced by the last one
+ * in its bucket
+ *
+ */
+
+#include "set.h"
+#include "stats.h"
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdbool.h>
+
+#define INLINE_SIZE 2
+#define OVERFLOW_SIZE 4
+
+#ifdef SETSTATS
+#define COUNT(x) ((x)++)
+#define RECORD(h, n) ((h)[statBucket(n)]++)
+#else
+#define COUNT(x) ((void) 0)
+#define RECORD(h, n) ((void) 0)
+#endif
+
+#define HASH(sp, elt) (COUNT((sp)->stats.hashes), (*(sp)->hash)(elt))
+#define COMPARE(sp, x, y) (COUNT((sp)->stats.compares), (*(sp)->compare)(x, y))
+
+/* An overflow array has room for size elements, followed
+ * by their tags */
+
+struct spill{
+
+	int size;
+	void *elts[];
+
+};
+
+/* Element i of a bucket is in slots if i < INLINE_SIZE and
+ * at spill->elts[i - INLINE_SIZE] otherwise, and its tag is
+ * in the same place in tags or after the spilled elements */
+
+struct chain{
+
+	int count;
+	unsigned short tags[INLINE_SIZE];
+	void *slots[INLINE_SIZE];
+	struct spill *spill;
+
+};
+
+struct setiter{
+
+	SET *sp;
+	int locn;
+	int index;
+
+};
+
+struct set{
+
+	struct chain *chains;
+	int length;
+	int count;
+	int (*compare)();
+	unsigned (*hash)();
+	int policy;
+	struct setiter iter;
+#ifdef SETSTATS
+	struct setstats stats;
+#endif
+
+};
+
+
+/* Tag
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns the tag for a hash key. The key is
+ * multiplied first so that every bit of it counts, since
+ * the low bits already chose the bucket
+ *
+ */
+
+static unsigned short tag(unsigned key){
+
+	return (key * 0x9e3779b1u) >> 16;
+
+}
+
+
+/* Spilled Tags
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns the tags of an overflow array
+ *
+ */
+
+static unsigned short *spilled(struct spill *op){
+
+	return (unsigned short *) (op->elts + op->size);
+
+}
+
+
+/* At
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns the address of element i of a
+ * bucket
+ *
+ */
+
+static void **at(struct chain *cp, int i){
+
+	return i < INLINE_SIZE ? &cp->slots[i] : &cp->spill->elts[i - INLINE_SIZE];
+
+}
+
+
+/* Tag At
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns the address of the tag of element
+ * i of a bucket
+ *
+ */
+
+static unsigned short *tagAt(struct chain *cp, int i){
+
+	return i < INLINE_SIZE ? &cp->tags[i] : &spilled(cp->spill)[i - INLINE_SIZE];
+
+}
+
+
+/* Search
+ *
+ * Complexity: O(n)
+ *
+ * Description: Returns the index in the bucket at locn of
+ * the element equal to elt, whose tag is t, or -1. The
+ * inline tags are scanned first and then the overflow
+ * array's
+ *
+ */
+
+static int search(SET *sp, int locn, void *elt, unsigned short t){
+
+	struct chain *cp = &sp->chains[locn];
+	int n = cp->count < INLINE_SIZE ? cp->count : INLINE_SIZE;
+	unsigned short *tags;
+
+	int i;
+	for(i = 0; i < n; i++){
+		if(cp->tags[i] == t && COMPARE(sp, cp->slots[i], elt) == 0){
+			RECORD(sp->stats.probes, i+1);
+			return i;
+		}
+	}
+
+	if(i < cp->count){
+		tags = spilled(cp->spill) - INLINE_SIZE;
+
+		for(; i < cp->count; i++){
+			if(tags[i] == t && COMPARE(sp, cp->spill->elts[i - INLINE_SIZE], elt) == 0){
+				RECORD(sp->stats.probes, i+1);
+				return i;
+			}
+		}
+	}
+
+	RECORD(sp->stats.probes, cp->count);
+	return -1;
+
+}
+
+
+/* Grow
+ *
+ * Complexity: O(n)
+ *
+ * Description: Gives a bucket an overflow array twice as
+ * large as the one it has, or OVERFLOW_SIZE to begin with,
+ * and moves the tags up past the new end of the elements
+ *
+ */
+
+static void grow(struct chain *cp){
+
+	int old = cp->spill ? cp->spill->size : 0;
+	int size = old ? old * 2 : OVERFLOW_SIZE;
+
+	cp->spill = realloc(cp->spill, sizeof(struct spill) +
+		(sizeof(void*) + sizeof(unsigned short)) * size);
+	assert(cp->spill);
+	cp->spill->size = size;
+	memmove(spilled(cp->spill), cp->spill->elts + old, sizeof(unsigned short) * old);
+
+}
+
+
+/* Append
+ *
+ * Complexity: O(1) amortized
+ *
+ * Description: Adds elt, whose tag is t, to the end of a
+ * bucket, doubling its overflow array if it is full
+ *
+ */
+
+static void append(struct chain *cp, void *elt, unsigned short t){
+
+	if(cp->count >= INLINE_SIZE + (cp->spill ? cp->spill->size : 0)) grow(cp);
+
+	*tagAt(cp, cp->count) = t;
+	*at(cp, cp->count++) = elt;
+
+}
+
+
+/* Drop
+ *
+ * Complexity: O(1)
+ *
+ * Description: Removes element i of a bucket and returns
+ * it, moving the last element of the bucket into its place.
+ * The overflow array is freed once the bucket fits inline
+ * again
+ *
+ */
+
+static void *drop(struct chain *cp, int i){
+
+	void *elt = *at(cp, i);
+
+	cp->count--;
+	*at(cp, i) = *at(cp, cp->count);
+	*tagAt(cp, i) = *tagAt(cp, cp->count);
+
+	if(cp->count <= INLINE_SIZE && cp->spill != NULL){
+		free(cp->spill);
+		cp->spill = NULL;
+	}
+
+	return elt;
+
+}
+
+
+/* Reorder
+ *
+ * Complexity: O(n)
+ *
+ * Description: Moves element i of a bucket, which was just
+ * found, as the set's policy says: to the front, shifting
+ * the elements before it up one place, or up one place by
+ * trading with the element before it. Its tag goes with
+ * it. Returns the element
+ *
+ */
+
+static void *reorder(SET *sp, struct chain *cp, int i){
+
+	void *elt = *at(cp, i);
+	unsigned short t = *tagAt(cp, i);
+	int j = sp->policy == SET_MOVE_TO_FRONT ? 0 : sp->policy == SET_TRANSPOSE ? i-1 : i;
+
+	if(j < 0 || j == i) return elt;
+
+	for(; i > j; i--){
+		*at(cp, i) = *at(cp, i-1);
+		*tagAt(cp, i) = *tagAt(cp, i-1);
+	}
+
+	*at(cp, j) = elt;
+	*tagAt(cp, j) = t;
+	return elt;
+
+}
+
+
+/* Create Set
+ *
+ * Complexity: O(n)
+ *
+ * Description: Allocates memory and creates an empty
+ * bucket for each location in hash table
+ *
+ */
+
+SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)()){
+
+	assert((*hash) && (*compare));
+
+	SET *sp;
+	sp = malloc(sizeof(SET));
+	assert(sp);
+	sp->chains = calloc(maxElts, sizeof(struct chain));
+	assert(sp->chains);
+	sp->compare = compare;
+	sp->hash = hash;
+	sp->policy = SET_FIXED;
+	sp->iter.sp = sp;
+	sp->length = maxElts;
+	sp->count = 0;
+#ifdef SETSTATS
+	memset(&sp->stats, 0, sizeof(struct setstats));
+#endif
+
+	return sp;
+
+}
+
+/* Destroy Set
+ *
+ * Complexity: O(n)
+ *
+ * Description: Deletes set by freeing each overflow
+ * array, and then entire set
+ *
+ */
+
+void destroySet(SET *sp){
+
+	assert(sp);
+
+	int i;
+	for(i = 0; i < sp->length; i++) free(sp->chains[i].spill);
+
+	free(sp->chains);
+	free(sp);
+
+}
+
+
+/* Number of Elements
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns number of elements in the set
+ *
+ */
+
+int numElements(SET *sp){
+
+	assert(sp);
+	return sp->count;
+
+}
+
+
+/* Add Element
+ *
+ * Complexity: O(n)
+ *
+ * Description: Determines whether item is already in
+ * set by scanning the bucket located at hashing key, and
+ * appends element to the bucket if it is not
+ *
+ */
+
+void addElement(SET *sp, void *elt){
+
+	unsigned key, locn;
+	int i;
+
+	assert(elt && sp);
+	assert(sp->count < sp->length);
+	key = HASH(sp, elt);
+	locn = key % sp->length;
+
+	i = search(sp, locn, elt, tag(key));
+
+	if(i == -1){
+		append(&sp->chains[locn], elt, tag(key));
+		sp->count++;
+
+	}
+
+	else reorder(sp, &sp->chains[locn], i);
+}
+
+/* Remove Element
+ *
+ * Complexity: O(n)
+ *
+ * Description: Utilizes search function to locate item
+ * in the bucket located at the hashing key, and drops it
+ * from the bucket
+ *
+ */
+
+void removeElement(SET *sp, void *elt){
+
+	assert(sp && elt);
+	unsigned key = HASH(sp, elt);
+	int i = search(sp, key % sp->length, elt, tag(key));
+
+	if(i != -1){
+		drop(&sp->chains[key % sp->length], i);
+		sp->count--;
+	}
+
+}
+
+/* Find Or Add Element
+ *
+ * Complexity: O(n)
+ *
+ * Description: Scans the bucket located at hashing key
+ * once, and appends elt to it if it was not there. Returns
+ * the element in the set afterwards
+ *
+ */
+
+void *findOrAddElement(SET *sp, void *elt, bool *inserted){
+
+	assert(sp && elt);
+	unsigned key = HASH(sp, elt);
+	struct chain *cp = &sp->chains[key % sp->length];
+	int i = search(sp, key % sp->length, elt, tag(key));
+
+	if(inserted) *inserted = i == -1;
+	if(i != -1) return reorder(sp, cp, i);
+
+	assert(sp->count < sp->length);
+	append(cp, elt, tag(key));
+	sp->count++;
+	return elt;
+
+}
+
+/* Toggle Element
+ *
+ * Complexity: O(n)
+ *
+ * Description: Scans the bucket located at hashing key
+ * once, and drops the element equal to elt if it is there
+ * and appends elt otherwise. Returns the element dropped,
+ * or NULL if elt was added
+ *
+ */
+
+void *toggleElement(SET *sp, void *elt){
+
+	assert(sp && elt);
+	unsigned key = HASH(sp, elt);
+	struct chain *cp = &sp->chains[key % sp->length];
+	int i = search(sp, key % sp->length, elt, tag(key));
+
+	if(i != -1){
+		sp->count--;
+		return drop(cp, i);
+	}
+
+	assert(sp->count < sp->length);
+	append(cp, elt, tag(key));
+	sp->count++;
+	return NULL;
+
+}
+
+/* Organize Set
+ *
+ * Complexity: O(1)
+ *
+ * Description: Sets the policy reorder follows when an
+ * element is found
+ *
+ */
+
+void organizeSet(SET *sp, int policy){
+
+	assert(sp);
+	assert(policy == SET_FIXED || policy == SET_MOVE_TO_FRONT ||
+		policy == SET_TRANSPOSE);
+	sp->policy = policy;
+
+}
+
+/* Find Element
+ *
+ * Complexity: O(n)
+ *
+ * Description: Scans bucket of elements located at
+ * hashing key to determine if exists, returns the item
+ * if found
+ *
+ */
+
+void *findElement(SET *sp, void *elt){
+
+	assert(sp && elt);
+
+	unsigned key = HASH(sp, elt);
+	int i = search(sp, key % sp->length, elt, tag(key));
+	return i == -1 ? NULL : reorder(sp, &sp->chains[key % sp->length], i);
+
+}
+
+
+/* Get Elements
+ *
+ * Complexity: O(n)
+ *
+ * Description: Copies every element contained in the set
+ * to a new array that is returned
+ *
+ */
+
+void *getElements(SET *sp){
+
+	assert(sp && (sp->count > 0));
+	void **elts;
+	struct chain *cp;
+
+	elts = malloc(sizeof(void *) * sp->count);
+	assert(elts);
+
+	int index = 0;
+
+	int i, j;
+	for(i = 0; i < sp->length; i++){
+
+		cp = &sp->chains[i];
+		for(j = 0; j < cp->count; j++) elts[index++] = *at(cp, j);
+
+	}
+
+	return elts;
+}
+
+
+/* Begin Set
+ *
+ * Complexity: O(1)
+ *
+ * Description: Starts the set's iterator over at the
+ * first bucket and returns it.
+ *
+ */
+
+SETITER *beginSet(SET *sp){
+
+	assert(sp);
+	sp->iter.locn = 0;
+	sp->iter.index = 0;
+	return &sp->iter;
+
+}
+
+
+/* Next Element
+ *
+ * Complexity: O(1) average case
+ *
+ * Description: Returns the next element in the current
+ * bucket, moving on to the following buckets when it runs
+ * out, or NULL once every bucket is done
+ *
+ */
+
+void *nextElement(SETITER *it){
+
+	assert(it);
+	struct chain *cp;
+
+	while(it->locn < it->sp->length){
+
+		cp = &it->sp->chains[it->locn];
+		if(it->index < cp->count) return *at(cp, it->index++);
+
+		it->locn++;
+		it->index = 0;
+
+	}
+
+	return NULL;
+
+}
+
+
+/* For Each Element
+ *
+ * Complexity: O(n)
+ *
+ * Description: Calls fn with each element and ctx
+ *
+ */
+
+void forEachElement(SET *sp, void (*fn)(), void *ctx){
+
+	assert(sp && fn);
+	struct chain *cp;
+
+	int i, j;
+	for(i = 0; i < sp->length; i++){
+
+		cp = &sp->chains[i];
+		for(j = 0; j < cp->count; j++) (*fn)(*at(cp, j), ctx);
+
+	}
+
+}
+
+
+/* Get Set Stats
+ *
+ * Complexity: O(n)
+ *
+ * Description: Fills in stats for the set. Each bucket is
+ * a chain, and empty buckets are counted as chains of
+ * length zero. The bytes include the overflow arrays
+ *
+ */
+
+void getSetStats(SET *sp, struct setstats *stats){
+
+	assert(sp && stats);
+	memset(stats, 0, sizeof(struct setstats));
+	stats->count = sp->count;
+	stats->length = sp->length;
+	stats->bytes = sizeof(SET) + sizeof(struct chain) * sp->length;
+
+	int i;
+	for(i = 0; i < sp->length; i++){
+
+		if(sp->chains[i].spill != NULL) stats->bytes += sizeof(struct spill) +
+			(sizeof(void*) + sizeof(unsigned short)) * sp->chains[i].spill->size;
+		stats->chains[statBucket(sp->chains[i].count)]++;
+
+	}
+
+#ifdef SETSTATS
+	stats->compares = sp->stats.compares;
+	stats->hashes = sp->stats.hashes;
+	memcpy(stats->probes, sp->stats.probes, sizeof(stats->probes));
+#else
+	stats->compares = -1;
+	stats->hashes = -1;
+#endif
+
+}
@@ -2,11 +2,20 @@
 #include "list.h"
 #include <assert.h>
 
+#ifdef SETSTATS
+#define COUNT(x) ((x)++)
+#else
+#define COUNT(x) ((void) 0)
+#endif
+
 typedef struct list{
 
 	int count;
 	struct node *head;
 	int (*compare)();
+#ifdef SETSTATS
+	long compares;
+#endif
 
 }LIST;
 
@@ -33,6 +42,9 @@ extern LIST *createList(int (*compare)()){
 	assert(nlist);
 	nlist->count = 0;
 	nlist->compare = compare;
+#ifdef SETSTATS
+	nlist->compares = 0;
+#endif
 
 	NODE *sent = malloc(sizeof(NODE));
 	assert(sent);
@@ -238,31 +250,36 @@ extern void *getLast(LIST *lp){
  *
  * Description: Traverses through entire list and 
  * checks with item passed into function, removes node
- * if data matches item
+ * if data matches item, returns the data removed and NULL
+ * if item was never found
  *
  */
 
-extern void removeItem(LIST *lp, void *item){
+extern void *removeItem(LIST *lp, void *item){
 
 	assert(lp && lp->compare);
 	assert(lp->count > 0);
+	void *data;
 	
 	NODE *temp = lp->head->next;
 	while(temp != lp->head){
 
+		COUNT(lp->compares);
 		if((lp->compare)(temp->data, item) == 0){
 
+			data = temp->data;
 			temp->prev->next = temp->next;
 			temp->next->prev = temp->prev;
 			free(temp);
 			lp->count--;
-			return;
+			return data;
 		}
 	
 		temp = temp->next;
 
 	}
 
+	return NULL;
 
 }
 
@@ -284,6 +301,7 @@ extern void *findItem(LIST *lp, void *item){
 	NODE *temp = lp->head->next;
 	while(temp != lp->head){
 
+		COUNT(lp->compares);
 		if((lp->compare)(temp->data, item) == 0) return temp->data;	
 	
 		temp = temp->next;
@@ -294,6 +312,87 @@ extern void *findItem(LIST *lp, void *item){
 }
 
 
+/* Promote Item
+ *
+ * Complexity: O(n)
+ *
+ * Description: Finds item as findItem does, and moves its
+ * node to the front of the list so the next search for it
+ * compares against it first. Returns data if matches and
+ * NULL if item was never found
+ *
+ */
+
+extern void *promoteItem(LIST *lp, void *item){
+
+	assert(lp && item);
+
+	NODE *temp = lp->head->next;
+	while(temp != lp->head){
+
+		COUNT(lp->compares);
+		if((lp->compare)(temp->data, item) == 0){
+
+			if(temp->prev != lp->head){
+				temp->prev->next = temp->next;
+				temp->next->prev = temp->prev;
+
+				lp->head->next->prev = temp;
+				temp->next = lp->head->next;
+				temp->prev = lp->head;
+				lp->head->next = temp;
+			}
+
+			return temp->data;
+		}
+	
+		temp = temp->next;
+	}
+
+	return NULL;
+
+}
+
+
+/* Transpose Item
+ *
+ * Complexity: O(n)
+ *
+ * Description: Finds item as findItem does, and swaps its
+ * data with the node before it, so items that are found
+ * often drift toward the front one place at a time.
+ * Returns data if matches and NULL if item was never found
+ *
+ */
+
+extern void *transposeItem(LIST *lp, void *item){
+
+	assert(lp && item);
+	void *data;
+
+	NODE *temp = lp->head->next;
+	while(temp != lp->head){
+
+		COUNT(lp->compares);
+		if((lp->compare)(temp->data, item) == 0){
+
+			data = temp->data;
+			if(temp->prev != lp->head){
+				temp->data = temp->prev->data;
+				temp->prev->data = data;
+			}
+
+			return data;
+		}
+	
+		temp = temp->next;
+	}
+
+	return NULL;
+
+}
+
+
 /* Get Items
  *
  * Complexity: O(n)
@@ -321,3 +420,86 @@ extern void *getItems(LIST *lp){
 	return dataList;
 
 }
+
+
+/* Next Item
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns the item after the node that
+ * cursor points to, and moves cursor to that item's node.
+ * A cursor of NULL starts at the first item. Returns NULL
+ * once the end of the list is reached
+ *
+ */
+
+extern void *nextItem(LIST *lp, void **cursor){
+
+	assert(lp && cursor);
+	NODE *temp = *cursor ? ((NODE *) *cursor)->next : lp->head->next;
+
+	if(temp == lp->head) return NULL;
+
+	*cursor = temp;
+	return temp->data;
+
+}
+
+
+/* For Each Item
+ *
+ * Complexity: O(n)
+ *
+ * Description: Traverses entire linked list and calls
+ * fn with the data from each node and ctx
+ *
+ */
+
+extern void forEachItem(LIST *lp, void (*fn)(), void *ctx){
+
+	assert(lp && fn);
+
+	NODE *temp;
+	for(temp = lp->head->next; temp != lp->head; temp = temp->next)
+		(*fn)(temp->data, ctx);
+
+}
+
+
+/* Size List
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns the number of bytes allocated
+ * for the list, its sentinel and its nodes
+ *
+ */
+
+extern size_t sizeList(LIST *lp){
+
+	assert(lp);
+	return sizeof(LIST) + sizeof(NODE) * (lp->count + 1);
+
+}
+
+
+/* Num Compares
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns the number of times the compare
+ * function has been called on the list, which is only
+ * counted if compiled with SETSTATS defined
+ *
+ */
+
+extern long numCompares(LIST *lp){
+
+	assert(lp);
+#ifdef SETSTATS
+	return lp->compares;
+#else
+	return 0;
+#endif
+
+}
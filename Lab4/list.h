@@ -13,6 +13,8 @@
 # ifndef LIST_H
 # define LIST_H
 
+# include <stddef.h>
+
 typedef struct list LIST;
 
 extern LIST *createList(int (*compare)());
@@ -33,10 +35,22 @@ extern void *getFirst(LIST *lp);
 
 extern void *getLast(LIST *lp);
 
-extern void removeItem(LIST *lp, void *item);
+extern void *removeItem(LIST *lp, void *item);
 
 extern void *findItem(LIST *lp, void *item);
 
+extern void *promoteItem(LIST *lp, void *item);
+
+extern void *transposeItem(LIST *lp, void *item);
+
 extern void *getItems(LIST *lp);
 
+extern void *nextItem(LIST *lp, void **cursor);
+
+extern void forEachItem(LIST *lp, void (*fn)(), void *ctx);
+
+extern size_t sizeList(LIST *lp);
+
+extern long numCompares(LIST *lp);
+
 # endif /* LIST_H */
@@ -15,7 +15,9 @@
 # include <stdio.h>
 # include <stdlib.h>
 # include <string.h>
+# include <stdbool.h>
 # include "set.h"
+# include "stats.h"
 
 
 /* This is sufficient for the test cases in /scratch/coen12. */
@@ -52,13 +54,23 @@ int main(int argc, char *argv[])
     FILE *fp;
     char buffer[BUFSIZ], *word;
     SET *odd;
-    int words;
+    struct setstats stats;
+    int i, words;
+    bool sflag = false;
 
 
     /* Check usage and open the file. */
 
+    while (argc > 1 && strcmp(argv[1], "-s") == 0) {
+	sflag = true;
+	argc --;
+
+	for (i = 1; i < argc; i ++)
+	    argv[i] = argv[i + 1];
+    }
+
     if (argc != 2) {
-        fprintf(stderr, "usage: %s file1\n", argv[0]);
+        fprintf(stderr, "usage: %s [-s] file1\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
@@ -87,6 +99,11 @@ int main(int argc, char *argv[])
     printf("%d words occur an odd number of times\n", numElements(odd));
     fclose(fp);
 
+    if (sflag) {
+	getSetStats(odd, &stats);
+	printStats(&stats);
+    }
+
     destroySet(odd);
     exit(EXIT_SUCCESS);
 }
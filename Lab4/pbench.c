@@ -0,0 +1,186 @@
+/*
+ * File:        pbench.c
+ *
+ * Author:      Riley Heike
+ *
+ * Description: This file contains the main function for measuring how the
+ *              thread-safe set abstract data type in cset.c scales with
+ *              the number of threads sharing it.
+ *
+ *              A vocabulary of distinct words is made and half of it added
+ *              to the set.  Then for each number of threads, doubling from
+ *              one up to the most asked for, every thread performs the same
+ *              number of operations on random words: a lookup with the
+ *              given probability and otherwise a toggle, which adds the
+ *              word if it is absent and removes it if it is present.  The
+ *              total number of operations per second is printed for each
+ *              number of threads, along with the speedup over one thread.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <pthread.h>
+# include <time.h>
+# include "set.h"
+
+# define MAX_THREADS 64
+
+static SET *sp;
+static char **words;
+static int vocab, nops;
+static double reads;
+
+
+/*
+ * Function:    strhash
+ *
+ * Description: Return a hash value for a string S.
+ */
+
+static unsigned strhash(char *s)
+{
+    unsigned hash = 0;
+
+
+    while (*s != '\0')
+        hash = 31 * hash + *s ++;
+
+    return hash;
+}
+
+
+/*
+ * Function:    worker
+ *
+ * Description: Perform the operations of one thread.
+ */
+
+static void *worker(void *arg)
+{
+    unsigned seed = (long) arg + 1;
+    char *word;
+    int i;
+
+
+    for (i = 0; i < nops; i ++) {
+	word = words[rand_r(&seed) % vocab];
+
+	if (rand_r(&seed) < reads * RAND_MAX)
+	    findElement(sp, word);
+	else
+	    toggleElement(sp, word);
+    }
+
+    return NULL;
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    pthread_t tids[MAX_THREADS];
+    struct timespec start, stop;
+    char buffer[32];
+    int i, maxThreads;
+    long t, n;
+    double seconds, rate, base;
+
+
+    /* Check usage. */
+
+    maxThreads = MAX_THREADS;
+    vocab = 100000;
+    nops = 1000000;
+    reads = 0.9;
+
+    while (argc > 2 && argv[1][0] == '-') {
+	if (strcmp(argv[1], "-t") == 0)
+	    maxThreads = atoi(argv[2]);
+	else if (strcmp(argv[1], "-v") == 0)
+	    vocab = atoi(argv[2]);
+	else if (strcmp(argv[1], "-n") == 0)
+	    nops = atoi(argv[2]);
+	else if (strcmp(argv[1], "-r") == 0)
+	    reads = atof(argv[2]);
+	else
+	    break;
+
+	argc -= 2;
+
+	for (i = 1; i < argc; i ++)
+	    argv[i] = argv[i + 2];
+    }
+
+    if (argc != 1 || maxThreads < 1 || maxThreads > MAX_THREADS || vocab < 1
+	|| nops < 1 || reads < 0 || reads > 1) {
+	fprintf(stderr, "usage: %s [-t threads] [-v vocabulary] "
+	    "[-n operations] [-r reads]\n", argv[0]);
+	exit(EXIT_FAILURE);
+    }
+
+
+    /* Make the vocabulary and add half of it. */
+
+    words = malloc(sizeof(char *) * vocab);
+
+    if (words == NULL) {
+	fprintf(stderr, "out of memory\n");
+	exit(EXIT_FAILURE);
+    }
+
+    for (i = 0; i < vocab; i ++) {
+	sprintf(buffer, "word%d", i);
+
+	if ((words[i] = strdup(buffer)) == NULL) {
+	    fprintf(stderr, "out of memory\n");
+	    exit(EXIT_FAILURE);
+	}
+    }
+
+    sp = createSet(vocab + 1, strcmp, strhash);
+
+    for (i = 0; i < vocab; i += 2)
+	addElement(sp, words[i]);
+
+
+    /* Run the operations with each number of threads. */
+
+    printf("%d operations per thread, %d words, %g reads\n", nops, vocab,
+	reads);
+    printf("%7s %15s %10s\n", "threads", "operations/s", "speedup");
+    base = 0;
+
+    for (n = 1; n <= maxThreads; n *= 2) {
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	for (t = 0; t < n; t ++)
+	    pthread_create(&tids[t], NULL, worker, (void *) t);
+
+	for (t = 0; t < n; t ++)
+	    pthread_join(tids[t], NULL);
+
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+	seconds = stop.tv_sec - start.tv_sec +
+	    (stop.tv_nsec - start.tv_nsec) / 1e9;
+	rate = n * nops / seconds;
+
+	if (base == 0)
+	    base = rate;
+
+	printf("%7ld %15.0f %10.2f\n", n, rate, rate / base);
+    }
+
+    destroySet(sp);
+
+    for (i = 0; i < vocab; i ++)
+	free(words[i]);
+
+    free(words);
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,286 @@
+/*
+ * File:        punique.c
+ *
+ * Author:      Riley Heike
+ *
+ * Description: This file contains the main function for testing a
+ *              thread-safe set abstract data type for strings.
+ *
+ *              It behaves like unique.c, except that each file is split
+ *              into as many byte ranges as there are threads and each
+ *              thread reads the words in its own range.  A word belongs to
+ *              the range in which it starts.  The number of threads is
+ *              given by the -t option and defaults to one.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <ctype.h>
+# include <stdbool.h>
+# include <pthread.h>
+# include <stdatomic.h>
+# include "set.h"
+# include "stats.h"
+
+
+/* This is sufficient for the test cases in /scratch/coen12. */
+
+# define MAX_SIZE 18000
+
+# define MAX_THREADS 64
+
+struct reader {
+    pthread_t thread;           /* thread reading this range       */
+    char *path;                 /* file being read                 */
+    long start, end;            /* byte range of words to read     */
+    bool remove;                /* delete words rather than insert */
+    char **copies;              /* words this thread added         */
+    int ncopies, maxcopies;     /* length and capacity of copies   */
+};
+
+static SET *unique;
+static atomic_int words;
+
+
+/*
+ * Function:    strhash
+ *
+ * Description: Return a hash value for a string S.
+ */
+
+static unsigned strhash(char *s)
+{
+    unsigned hash = 0;
+
+
+    while (*s != '\0')
+        hash = 31 * hash + *s ++;
+
+    return hash;
+}
+
+
+/*
+ * Function:    keep
+ *
+ * Description: Record that the reader RP owns the word COPY so that it
+ *              can be deallocated once every thread has finished.
+ */
+
+static void keep(struct reader *rp, char *copy)
+{
+    if (rp->ncopies == rp->maxcopies) {
+	rp->maxcopies = rp->maxcopies ? rp->maxcopies * 2 : 1024;
+	rp->copies = realloc(rp->copies, sizeof(char *) * rp->maxcopies);
+
+	if (rp->copies == NULL) {
+	    fprintf(stderr, "out of memory\n");
+	    exit(EXIT_FAILURE);
+	}
+    }
+
+    rp->copies[rp->ncopies ++] = copy;
+}
+
+
+/*
+ * Function:    readRange
+ *
+ * Description: Thread function that inserts or deletes every word that
+ *              starts within the byte range of the reader ARG.  If the
+ *              range begins in the middle of a word, that word belongs to
+ *              the previous range and is skipped.  A thread that loses a
+ *              race to insert a word is told so by findOrAddElement, and
+ *              deallocates its own copy.
+ */
+
+static void *readRange(void *arg)
+{
+    FILE *fp;
+    struct reader *rp = arg;
+    char buffer[BUFSIZ], *copy;
+    bool inserted;
+    int c;
+
+
+    if ((fp = fopen(rp->path, "r")) == NULL) {
+        fprintf(stderr, "cannot open %s\n", rp->path);
+        exit(EXIT_FAILURE);
+    }
+
+    if (rp->start > 0) {
+	fseek(fp, rp->start - 1, SEEK_SET);
+
+	if (!isspace(getc(fp))) {
+	    while ((c = getc(fp)) != EOF && !isspace(c))
+		;
+	}
+    }
+
+    while (fscanf(fp, " ") != EOF && ftell(fp) < rp->end) {
+	if (fscanf(fp, "%s", buffer) != 1)
+	    break;
+
+	if (rp->remove)
+	    removeElement(unique, buffer);
+
+	else {
+	    atomic_fetch_add(&words, 1);
+
+	    if (findElement(unique, buffer) == NULL) {
+		copy = strdup(buffer);
+		findOrAddElement(unique, copy, &inserted);
+
+		if (inserted)
+		    keep(rp, copy);
+		else
+		    free(copy);
+	    }
+	}
+    }
+
+    fclose(fp);
+    return NULL;
+}
+
+
+/*
+ * Function:    readFile
+ *
+ * Description: Split the file PATH into one range per reader and run the
+ *              readers in parallel, either inserting or deleting words.
+ */
+
+static void readFile(struct reader *readers, int nthreads, char *path,
+	bool remove)
+{
+    FILE *fp;
+    long size;
+    int i;
+
+
+    if ((fp = fopen(path, "r")) == NULL) {
+        fprintf(stderr, "cannot open %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fclose(fp);
+
+    for (i = 0; i < nthreads; i ++) {
+	readers[i].path = path;
+	readers[i].start = size * i / nthreads;
+	readers[i].end = size * (i + 1) / nthreads;
+	readers[i].remove = remove;
+	pthread_create(&readers[i].thread, NULL, readRange, &readers[i]);
+    }
+
+    for (i = 0; i < nthreads; i ++)
+	pthread_join(readers[i].thread, NULL);
+}
+
+
+/*
+ * Function:    printElement
+ *
+ * Description: Print the string ELT on a line of its own to FP.
+ */
+
+static void printElement(char *elt, FILE *fp)
+{
+    fprintf(fp, "%s\n", elt);
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the test application.
+ */
+
+int main(int argc, char *argv[])
+{
+    struct reader readers[MAX_THREADS];
+    struct setstats stats;
+    int i, j, nthreads = 1;
+    bool lflag = false, sflag = false;
+
+
+    /* Check usage. */
+
+    while (argc > 1 && argv[1][0] == '-') {
+	if (strcmp(argv[1], "-l") == 0) {
+	    lflag = true;
+	    j = 1;
+
+	} else if (strcmp(argv[1], "-s") == 0) {
+	    sflag = true;
+	    j = 1;
+
+	} else if (strcmp(argv[1], "-t") == 0 && argc > 2) {
+	    nthreads = atoi(argv[2]);
+	    j = 2;
+
+	} else
+	    break;
+
+	argc -= j;
+
+	for (i = 1; i < argc; i ++)
+	    argv[i] = argv[i + j];
+    }
+
+    if (argc == 1 || argc > 3 || nthreads < 1 || nthreads > MAX_THREADS) {
+        fprintf(stderr, "usage: %s [-l] [-s] [-t threads] file1 [file2]\n",
+	    argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(readers, 0, sizeof(readers));
+
+
+    /* Insert all words into the set. */
+
+    unique = createSet(MAX_SIZE, strcmp, strhash);
+    readFile(readers, nthreads, argv[1], false);
+
+    if (!lflag) {
+	printf("%d total words\n", atomic_load(&words));
+	printf("%d distinct words\n", numElements(unique));
+    }
+
+
+    /* Delete all words in the second file. */
+
+    if (argc == 3) {
+	readFile(readers, nthreads, argv[2], true);
+
+	if (!lflag)
+	    printf("%d remaining words\n", numElements(unique));
+    }
+
+
+    /* Print the list of words if desired. */
+
+    if (lflag) {
+	forEachElement(unique, printElement, stdout);
+    }
+
+    if (sflag) {
+	getSetStats(unique, &stats);
+	printStats(&stats);
+    }
+
+    destroySet(unique);
+
+    for (i = 0; i < nthreads; i ++) {
+	for (j = 0; j < readers[i].ncopies; j ++)
+	    free(readers[i].copies[j]);
+
+	free(readers[i].copies);
+    }
+
+    exit(EXIT_SUCCESS);
+}
@@ -1,28 +1,203 @@
 #include "set.h"
+#include "stats.h"
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "list.h"
 
+/* A bucket only has a list while it has elements: the list
+ * is created by the first add and destroyed by the last
+ * remove. Bit i of present is set while bucket i has a
+ * list, so looking in an empty bucket reads one bit and no
+ * list, and creating or destroying a set costs nothing per
+ * empty bucket */
+
+#ifdef SETSTATS
+#define COUNT(x) ((x)++)
+#define RECORD(h, n) ((h)[statBucket(n)]++)
+#else
+#define COUNT(x) ((void) 0)
+#define RECORD(h, n) ((void) 0)
+#endif
+
+#define HASH(sp, elt) (COUNT((sp)->stats.hashes), (*(sp)->hash)(elt))
+
+struct setiter{
+
+	SET *sp;
+	int locn;
+	void *cursor;
+
+};
+
 typedef struct set{
 
 	LIST **elts;
+	uint64_t *present;
 	int length;
 	int count;
 	int (*compare)();
 	unsigned (*hash)();
+	void *(*look)(LIST *, void *);
+	struct setiter iter;
+#ifdef SETSTATS
+	struct setstats stats;
+#endif
 
 }SET;
 
 
+/* Has
+ *
+ * Complexity: O(1)
+ *
+ * Description: Returns whether the bucket at locn has a
+ * list
+ *
+ */
 
-/* Create Set
+static bool has(SET *sp, int locn){
+
+	return sp->present[locn / 64] >> (locn % 64) & 1;
+
+}
+
+
+/* Following
+ *
+ * Complexity: O(n)
+ *
+ * Description: Returns the first bucket at or after locn
+ * that has a list, or the length of the table if there is
+ * none, skipping 64 empty buckets at a time
+ *
+ */
+
+static int following(SET *sp, int locn){
+
+	uint64_t word;
+	int w = locn / 64;
+
+	if(locn >= sp->length) return sp->length;
+	word = sp->present[w] & (~0ULL << (locn % 64));
+
+	while(word == 0){
+		if(++w * 64 >= sp->length) return sp->length;
+		word = sp->present[w];
+	}
+
+	return w * 64 + __builtin_ctzll(word);
+
+}
+
+
+/* Find
  *
  * Complexity: O(n)
  *
- * Description: Allocates memory and creates list for each 
- * location in hash table
+ * Description: Returns the item equal to elt in the list
+ * at locn, or NULL, reordering the list as organizeSet
+ * chose. An empty bucket is answered from the
+ * bitmap alone. If counting, records how many items the
+ * list compared against
+ *
+ */
+
+static void *find(SET *sp, int locn, void *elt){
+
+	if(!has(sp, locn)){
+		RECORD(sp->stats.probes, 0);
+		return NULL;
+	}
+
+#ifdef SETSTATS
+	long before = numCompares(sp->elts[locn]);
+	void *item = (*sp->look)(sp->elts[locn], elt);
+	RECORD(sp->stats.probes, numCompares(sp->elts[locn]) - before);
+	return item;
+#else
+	return (*sp->look)(sp->elts[locn], elt);
+#endif
+
+}
+
+
+/* Put
+ *
+ * Complexity: O(1)
+ *
+ * Description: Adds elt to the front of the list at locn,
+ * creating the list if the bucket was empty
+ *
+ */
+
+static void put(SET *sp, int locn, void *elt){
+
+	if(!has(sp, locn)){
+		sp->elts[locn] = createList(sp->compare);
+		sp->present[locn / 64] |= 1ULL << (locn % 64);
+	}
+
+	addFirst(sp->elts[locn], elt);
+	sp->count++;
+
+}
+
+
+/* Take
+ *
+ * Complexity: O(n)
+ *
+ * Description: Removes the item equal to elt from the list
+ * at locn in one pass, destroying the list if it is left
+ * empty. Returns the item removed, or NULL. If counting,
+ * records how many items the list compared against
+ *
+ */
+
+static void *take(SET *sp, int locn, void *elt){
+
+	void *item;
+
+	if(!has(sp, locn)){
+		RECORD(sp->stats.probes, 0);
+		return NULL;
+	}
+
+#ifdef SETSTATS
+	long before = numCompares(sp->elts[locn]);
+	item = removeItem(sp->elts[locn], elt);
+	RECORD(sp->stats.probes, numCompares(sp->elts[locn]) - before);
+#else
+	item = removeItem(sp->elts[locn], elt);
+#endif
+
+	if(item != NULL){
+		sp->count--;
+
+		if(numItems(sp->elts[locn]) == 0){
+#ifdef SETSTATS
+			sp->stats.compares += numCompares(sp->elts[locn]);
+#endif
+			destroyList(sp->elts[locn]);
+			sp->present[locn / 64] &= ~(1ULL << (locn % 64));
+		}
+	}
+
+	return item;
+
+}
+
+
+/* Create Set
+ *
+ * Complexity: O(1)
+ *
+ * Description: Allocates memory for the hash table and
+ * its bitmap, all buckets empty. No lists are created until
+ * elements are added
  *
  */
 
@@ -34,14 +209,17 @@ SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)()){
 	sp = malloc(sizeof(SET));
 	assert(sp);
 	sp->elts = malloc(sizeof(void*) * maxElts);
-	assert(sp->elts);
+	sp->present = calloc((maxElts + 63) / 64, sizeof(uint64_t));
+	assert(sp->elts && sp->present);
 	sp->compare = compare;
 	sp->hash = hash;
+	sp->look = findItem;
+	sp->iter.sp = sp;
 	sp->length = maxElts;
 	sp->count = 0;
-
-	int i;
-	for(i = 0; i < sp->length; i++) sp->elts[i] = createList(sp->compare);
+#ifdef SETSTATS
+	memset(&sp->stats, 0, sizeof(struct setstats));
+#endif
 
 	return sp;
 
@@ -52,7 +230,8 @@ SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)()){
  * Complexity: O(n)
  *
  * Description: Deletes set by freeing each list, and
- * then entire set
+ * then entire set. Only buckets marked in the bitmap have
+ * lists to free
  *
  */
 
@@ -61,13 +240,14 @@ void destroySet(SET *sp){
 	assert(sp);
 
 	int i;
-	for(i = 0; i < sp->length; i++){
+	for(i = following(sp, 0); i < sp->length; i = following(sp, i+1)){
 
 		destroyList(sp->elts[i]);
 
 	}
 
 	free(sp->elts);
+	free(sp->present);
 	free(sp);
 	
 }
@@ -95,7 +275,8 @@ int numElements(SET *sp){
  *
  * Description: Determines whether item is already
  * in set by going through list located at hashing key,
- * adds element if it is not
+ * adds element if it is not, creating the list if the
+ * bucket was empty
  *
  */
 
@@ -105,32 +286,98 @@ void addElement(SET *sp, void *elt){
 
 	assert(elt && sp);
 	assert(sp->count < sp->length);
-	locn = (sp->hash)(elt) % sp->length;
-
-	if(findItem(sp->elts[locn], elt) == NULL){
-		addFirst(sp->elts[locn], elt);
-		sp->count++;
+	locn = HASH(sp, elt) % sp->length;
 
-	}
+	if(find(sp, locn, elt) == NULL) put(sp, locn, elt);
 }
 
 /* Remove Element
  * 
  * Complexity: O(n)
  *
- * Description: Utilizes findItem function to locate item
- * if it is in the lsit located at the hashing key
+ * Description: Utilizes removeItem function to remove item
+ * if it is in the list located at the hashing key, in one
+ * pass over the list
  *
  */
 
 void removeElement(SET *sp, void *elt){
 
 	assert(sp && elt);
-	int key = (sp->hash)(elt) % sp->length;
+	int key = HASH(sp, elt) % sp->length;
+	take(sp, key, elt);
 
-	if(findItem(sp->elts[key], elt) != NULL){
-		removeItem(sp->elts[key], elt);
-		sp->count--;
+}
+
+/* Find Or Add Element
+ *
+ * Complexity: O(n)
+ *
+ * Description: Goes through list of elements located at
+ * hashing key once, and adds elt to the front if it was
+ * not there. Returns the element in the set afterwards
+ *
+ */
+
+void *findOrAddElement(SET *sp, void *elt, bool *inserted){
+
+	assert(sp && elt);
+	unsigned locn = HASH(sp, elt) % sp->length;
+	void *item = find(sp, locn, elt);
+
+	if(inserted) *inserted = item == NULL;
+	if(item != NULL) return item;
+
+	assert(sp->count < sp->length);
+	put(sp, locn, elt);
+	return elt;
+
+}
+
+/* Toggle Element
+ *
+ * Complexity: O(n)
+ *
+ * Description: Removes the element equal to elt from the
+ * list at hashing key in one pass, and adds elt to the
+ * front if nothing was removed. Returns the element
+ * removed, or NULL if elt was added
+ *
+ */
+
+void *toggleElement(SET *sp, void *elt){
+
+	assert(sp && elt);
+	unsigned locn = HASH(sp, elt) % sp->length;
+	void *item = take(sp, locn, elt);
+
+	if(item == NULL){
+		assert(sp->count < sp->length);
+		put(sp, locn, elt);
+	}
+	return item;
+
+}
+
+/* Organize Set
+ *
+ * Complexity: O(1)
+ *
+ * Description: Chooses the list function that searches a
+ * bucket: findItem leaves it alone, promoteItem moves a hit
+ * to the front and transposeItem moves it up one place
+ *
+ */
+
+void organizeSet(SET *sp, int policy){
+
+	assert(sp);
+
+	if(policy == SET_MOVE_TO_FRONT) sp->look = promoteItem;
+	else if(policy == SET_TRANSPOSE) sp->look = transposeItem;
+	else{
+		assert(policy == SET_FIXED);
+		sp->look = findItem;
 	}
 
 }
@@ -149,8 +396,8 @@ void *findElement(SET *sp, void *elt){
 
 	assert(sp && elt);
 	
-	int i = (sp->hash)(elt) % sp->length;
-	return findItem(sp->elts[i], elt);
+	int i = HASH(sp, elt) % sp->length;
+	return find(sp, i, elt);
 	
 
 }
@@ -169,7 +416,7 @@ void *getElements(SET *sp){
 
 	assert(sp && (sp->count > 0));
 	void **elts;
-	void **temp;	
+	void *cursor, *elt;
 
 	elts = malloc(sizeof(void *) * sp->count);
 	assert(elts);
@@ -177,15 +424,129 @@ void *getElements(SET *sp){
 	int index = 0;
 
 	int i;
-	for(i = 0; i < sp->length; i++){
+	for(i = following(sp, 0); i < sp->length; i = following(sp, i+1)){
 
-		temp = getItems(sp->elts[i]);
-		memcpy(elts+index, temp, sizeof(void *) * numItems(sp->elts[i]));	
-	
-		index += numItems(sp->elts[i]);
-		free(temp);
+		cursor = NULL;
+		while((elt = nextItem(sp->elts[i], &cursor)) != NULL)
+			elts[index++] = elt;
 
 	}
 
 	return elts;
 }
+
+
+/* Begin Set
+ *
+ * Complexity: O(1)
+ *
+ * Description: Starts the set's iterator over at the
+ * first bucket and returns it.
+ *
+ */
+
+SETITER *beginSet(SET *sp){
+
+	assert(sp);
+	sp->iter.locn = 0;
+	sp->iter.cursor = NULL;
+	return &sp->iter;
+
+}
+
+
+/* Next Element
+ *
+ * Complexity: O(1) average case
+ *
+ * Description: Returns the next element in the current
+ * bucket's list, moving on to the following buckets with
+ * lists when it runs out, or NULL once every bucket is done
+ *
+ */
+
+void *nextElement(SETITER *it){
+
+	assert(it);
+	void *elt;
+
+	while((it->locn = following(it->sp, it->locn)) < it->sp->length){
+
+		elt = nextItem(it->sp->elts[it->locn], &it->cursor);
+		if(elt != NULL) return elt;
+
+		it->locn++;
+		it->cursor = NULL;
+
+	}
+
+	return NULL;
+
+}
+
+
+/* For Each Element
+ *
+ * Complexity: O(n)
+ *
+ * Description: Calls fn with each element and ctx
+ *
+ */
+
+void forEachElement(SET *sp, void (*fn)(), void *ctx){
+
+	assert(sp && fn);
+
+	int i;
+	for(i = following(sp, 0); i < sp->length; i = following(sp, i+1))
+		forEachItem(sp->elts[i], fn, ctx);
+
+}
+
+
+/* Get Set Stats
+ *
+ * Complexity: O(n)
+ *
+ * Description: Fills in stats for the set. Each bucket's
+ * list is a chain, and empty buckets are counted as chains
+ * of length zero. Compares are counted by the lists, and
+ * by the set for lists since destroyed
+ *
+ */
+
+void getSetStats(SET *sp, struct setstats *stats){
+
+	assert(sp && stats);
+	memset(stats, 0, sizeof(struct setstats));
+	stats->count = sp->count;
+	stats->length = sp->length;
+	stats->bytes = sizeof(SET) + sizeof(LIST *) * sp->length +
+		sizeof(uint64_t) * ((sp->length + 63) / 64);
+	stats->chains[0] = sp->length;
+#ifdef SETSTATS
+	stats->compares = sp->stats.compares;
+#endif
+
+	int i;
+	for(i = following(sp, 0); i < sp->length; i = following(sp, i+1)){
+
+		stats->chains[0]--;
+		stats->bytes += sizeList(sp->elts[i]);
+		stats->chains[statBucket(numItems(sp->elts[i]))]++;
+
+#ifdef SETSTATS
+		stats->compares += numCompares(sp->elts[i]);
+#endif
+
+	}
+
+#ifdef SETSTATS
+	stats->hashes = sp->stats.hashes;
+	memcpy(stats->probes, sp->stats.probes, sizeof(stats->probes));
+#else
+	stats->compares = -1;
+	stats->hashes = -1;
+#endif
+
+}
@@ -12,8 +12,35 @@
 # ifndef SET_H
 # define SET_H
 
+# include <stddef.h>
+# include <stdbool.h>
+
 typedef struct set SET;
 
+typedef struct setiter SETITER;
+
+/*
+ * Statistics about a set.  A histogram counts lengths by powers of two:
+ * bucket 0 counts lengths of zero and bucket k counts lengths from
+ * 2^(k-1) to 2^k - 1.  The compare and hash counts and the histogram of
+ * probes are only kept if the set is compiled with -DSETSTATS; otherwise
+ * the counts are -1 and the histogram is empty, and the set does no extra
+ * work.  The other fields are worked out when the statistics are asked for.
+ */
+
+# define STAT_BUCKETS 32
+
+struct setstats {
+    int count;                  /* number of elements                  */
+    int length;                 /* number of slots or buckets          */
+    int tombstones;             /* deleted slots not yet reused        */
+    size_t bytes;               /* bytes allocated by the set          */
+    long compares;              /* calls to the compare function       */
+    long hashes;                /* calls to the hash function          */
+    long probes[STAT_BUCKETS];  /* searches by elements examined       */
+    long chains[STAT_BUCKETS];  /* filled runs or chains by length     */
+};
+
 SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)());
 
 void destroySet(SET *sp);
@@ -28,4 +55,48 @@ void *findElement(SET *sp, void *elt);
 
 void *getElements(SET *sp);
 
+/*
+ * findOrAddElement returns the element equal to ELT, adding ELT if there
+ * was none, and sets *INSERTED, if given, to whether it was added.
+ * toggleElement adds ELT if no equal element is there and returns NULL,
+ * and otherwise removes the equal element and returns it, so the caller
+ * can free it.  Each looks for ELT only once.
+ */
+
+void *findOrAddElement(SET *sp, void *elt, bool *inserted);
+
+void *toggleElement(SET *sp, void *elt);
+
+/*
+ * organizeSet chooses how a set reorders each bucket as elements are
+ * found in it, so that elements found often are compared against first.
+ * With SET_MOVE_TO_FRONT an element found moves to the front of its
+ * bucket, and with SET_TRANSPOSE it trades places with the element before
+ * it.  A set starts out SET_FIXED, and its buckets are then only changed
+ * by adding and removing.  Unless the set is SET_FIXED, finding an element
+ * changes the set, so it must not be done during a walk.
+ */
+
+# define SET_FIXED		0
+# define SET_MOVE_TO_FRONT	1
+# define SET_TRANSPOSE		2
+
+void organizeSet(SET *sp, int policy);
+
+void getSetStats(SET *sp, struct setstats *stats);
+
+/*
+ * An iterator walks the elements of a set where they are stored, so that
+ * they can be visited without copying them into an array.  Each set has
+ * a single iterator, and beginSet starts it over, so only one walk of a
+ * set can be under way at once.  The set must not be changed during a
+ * walk.  forEachElement calls FN with each element and CTX in turn.
+ */
+
+SETITER *beginSet(SET *sp);
+
+void *nextElement(SETITER *it);
+
+void forEachElement(SET *sp, void (*fn)(), void *ctx);
+
 # endif /* SET_H */
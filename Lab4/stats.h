@@ -0,0 +1,25 @@
+/*
+ * File:        stats.h
+ *
+ * Author:      Riley Heike
+ *
+ * Description: This file contains the function declarations shared by the
+ *              sets, which sort lengths into the buckets of a histogram,
+ *              and by the programs, which print the statistics of a set.
+ */
+
+# ifndef STATS_H
+# define STATS_H
+
+# include "set.h"
+
+/*
+ * statBucket returns the histogram bucket for a length N, as described for
+ * struct setstats.  printStats prints STATS on standard error.
+ */
+
+int statBucket(long n);
+
+void printStats(struct setstats *stats);
+
+# endif /* STATS_H */
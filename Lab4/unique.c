@@ -19,6 +19,7 @@
 # include <string.h>
 # include <stdbool.h>
 # include "set.h"
+# include "stats.h"
 
 
 /* This is sufficient for the test cases in /scratch/coen12. */
@@ -44,6 +45,18 @@ static unsigned strhash(char *s)
 }
 
 
+/*
+ * Function:    printElement
+ *
+ * Description: Print the string ELT on a line of its own to FP.
+ */
+
+static void printElement(char *elt, FILE *fp)
+{
+    fprintf(fp, "%s\n", elt);
+}
+
+
 /*
  * Function:    main
  *
@@ -53,16 +66,23 @@ static unsigned strhash(char *s)
 int main(int argc, char *argv[])
 {
     FILE *fp;
-    char buffer[BUFSIZ], **elts, *word;
+    char buffer[BUFSIZ], *word;
     SET *unique;
+    struct setstats stats;
     int i, words;
-    bool lflag = false;
+    bool lflag = false, sflag = false;
 
 
     /* Check usage and open the first file. */
 
-    if (argc > 1 && strcmp(argv[1], "-l") == 0) {
-	lflag = true;
+    while (argc > 1 && argv[1][0] == '-') {
+	if (strcmp(argv[1], "-l") == 0)
+	    lflag = true;
+	else if (strcmp(argv[1], "-s") == 0)
+	    sflag = true;
+	else
+	    break;
+
 	argc --;
 
 	for (i = 1; i < argc; i ++)
@@ -70,7 +90,7 @@ int main(int argc, char *argv[])
     }
 
     if (argc == 1 || argc > 3) {
-        fprintf(stderr, "usage: %s [-l] file1 [file2]\n", argv[0]);
+        fprintf(stderr, "usage: %s [-l] [-s] file1 [file2]\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
@@ -127,12 +147,12 @@ int main(int argc, char *argv[])
     /* Print the list of words if desired. */
 
     if (lflag) {
-	elts = getElements(unique);
-
-	for (i = 0; i < numElements(unique); i ++)
-	    printf("%s\n", elts[i]);
+	forEachElement(unique, printElement, stdout);
+    }
 
-	free(elts);
+    if (sflag) {
+	getSetStats(unique, &stats);
+	printStats(&stats);
     }
 
     destroySet(unique);
@@ -0,0 +1,219 @@
+/*
+ * File:        zipf.c
+ *
+ * Author: Riley Heike
+ *
+ * Description: This file contains the main function for measuring how the
+ *              bucket orders chosen by organizeSet affect a set abstract
+ *              data type for strings on skewed input.
+ *
+ *              A synthetic corpus is drawn from a vocabulary of distinct
+ *              words whose frequencies follow Zipf's law: the word of rank
+ *              k occurs with probability proportional to 1 / k^a, as words
+ *              do in English text.  The ranks are shuffled so that frequent
+ *              words are not also the first ones hashed.  The corpus is
+ *              then fed to a fresh set once for each bucket order, adding
+ *              each word that is not already present, and the average
+ *              number of compares per word is printed along with the time
+ *              taken.  Compares are counted by the comparison function
+ *              itself, so the set need not be compiled with SETSTATS.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <math.h>
+# include <time.h>
+# include "set.h"
+
+
+static long compares;
+
+
+/*
+ * Function:    strhash
+ *
+ * Description: Return a hash value for a string S.
+ */
+
+static unsigned strhash(char *s)
+{
+    unsigned hash = 0;
+
+
+    while (*s != '\0')
+        hash = 31 * hash + *s ++;
+
+    return hash;
+}
+
+
+/*
+ * Function:    countCompare
+ *
+ * Description: Compare two strings as in strcmp(), counting the call.
+ */
+
+static int countCompare(char *s, char *t)
+{
+    compares ++;
+    return strcmp(s, t);
+}
+
+
+/*
+ * Function:    makeWord
+ *
+ * Description: Return a new string that spells out N in base 26, so that
+ *              distinct numbers give distinct words.
+ */
+
+static char *makeWord(int n)
+{
+    char buffer[16];
+    int i = 0;
+    char *word;
+
+
+    do {
+	buffer[i ++] = 'a' + n % 26;
+	n /= 26;
+    } while (n > 0);
+
+    buffer[i] = '\0';
+    word = strdup(buffer);
+
+    if (word == NULL) {
+	fprintf(stderr, "out of memory\n");
+	exit(EXIT_FAILURE);
+    }
+
+    return word;
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    static char *names[] = {"fixed", "move-to-front", "transpose"};
+    static int policies[] = {SET_FIXED, SET_MOVE_TO_FRONT, SET_TRANSPOSE};
+    int i, j, k, lo, hi, buckets, nwords, vocab;
+    char **words, **corpus, *temp;
+    double a, u, *cdf;
+    clock_t start;
+    SET *sp;
+
+
+    /* Check usage. */
+
+    nwords = 1000000;
+    vocab = 50000;
+    buckets = 0;
+    a = 1.0;
+
+    while (argc > 2 && argv[1][0] == '-') {
+	if (strcmp(argv[1], "-n") == 0)
+	    nwords = atoi(argv[2]);
+	else if (strcmp(argv[1], "-v") == 0)
+	    vocab = atoi(argv[2]);
+	else if (strcmp(argv[1], "-b") == 0)
+	    buckets = atoi(argv[2]);
+	else if (strcmp(argv[1], "-a") == 0)
+	    a = atof(argv[2]);
+	else
+	    break;
+
+	argc -= 2;
+
+	for (i = 1; i < argc; i ++)
+	    argv[i] = argv[i + 2];
+    }
+
+    if (buckets == 0)
+	buckets = vocab + 1;
+
+    if (argc != 1 || nwords < 1 || vocab < 1 || buckets <= vocab || a <= 0) {
+	fprintf(stderr, "usage: %s [-n words] [-v vocabulary] [-b buckets] "
+	    "[-a exponent]\n", argv[0]);
+	fprintf(stderr, "the buckets must outnumber the vocabulary\n");
+	exit(EXIT_FAILURE);
+    }
+
+
+    /* Make the vocabulary, shuffled, and the Zipf distribution over it. */
+
+    srand48(1);
+    words = malloc(sizeof(char *) * vocab);
+    cdf = malloc(sizeof(double) * vocab);
+    corpus = malloc(sizeof(char *) * nwords);
+
+    if (words == NULL || cdf == NULL || corpus == NULL) {
+	fprintf(stderr, "out of memory\n");
+	exit(EXIT_FAILURE);
+    }
+
+    for (k = 0; k < vocab; k ++) {
+	words[k] = makeWord(k);
+	j = lrand48() % (k + 1);
+	temp = words[k];
+	words[k] = words[j];
+	words[j] = temp;
+    }
+
+    for (k = 0; k < vocab; k ++)
+	cdf[k] = (k > 0 ? cdf[k - 1] : 0) + 1 / pow(k + 1, a);
+
+
+    /* Draw the corpus, finding each word's rank by binary search. */
+
+    for (i = 0; i < nwords; i ++) {
+	u = drand48() * cdf[vocab - 1];
+
+	for (lo = 0, hi = vocab - 1; lo < hi; ) {
+	    k = (lo + hi) / 2;
+
+	    if (cdf[k] < u)
+		lo = k + 1;
+	    else
+		hi = k;
+	}
+
+	corpus[i] = words[lo];
+    }
+
+
+    /* Run the corpus through a set with each bucket order. */
+
+    printf("%d words, %d distinct at most, %d buckets, exponent %g\n",
+	nwords, vocab, buckets, a);
+    printf("%-15s %15s %10s\n", "order", "compares/word", "seconds");
+
+    for (j = 0; j < (int) (sizeof(policies) / sizeof(policies[0])); j ++) {
+	sp = createSet(buckets, countCompare, strhash);
+	organizeSet(sp, policies[j]);
+
+	compares = 0;
+	start = clock();
+
+	for (i = 0; i < nwords; i ++)
+	    findOrAddElement(sp, corpus[i], NULL);
+
+	printf("%-15s %15.3f %10.3f\n", names[j], (double) compares / nwords,
+	    (double) (clock() - start) / CLOCKS_PER_SEC);
+
+	destroySet(sp);
+    }
+
+    for (k = 0; k < vocab; k ++)
+	free(words[k]);
+
+    free(words);
+    free(cdf);
+    free(corpus);
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,162 @@
+/*
+ * File:        latency.c
+ *
+ * Author:      Riley Heike
+ *
+ * Description: This file contains the main function for measuring the
+ *              latency of single insertions into a set abstract data type
+ *              for generic pointer types as the set grows.
+ *
+ *              Distinct elements are added one at a time to a set created
+ *              for a thousand elements, and each insertion is timed on its
+ *              own.  For each power of ten the set grows through, the
+ *              median, 99th and 99.9th percentile, and largest insertion
+ *              times are printed in nanoseconds.  A table that rehashes
+ *              every element at once when it grows shows this in the
+ *              largest times and, once resizes come often enough, in the
+ *              99th percentile; an incremental resize should keep both
+ *              flat as the set grows.
+ *
+ *              Built with table.c as latency, the table migrates a few
+ *              slots per operation.  Built as latencyW, with table.c
+ *              compiled so that MIGRATE_STEPS covers the whole array, the
+ *              first operation after a resize moves every element, which
+ *              is the stop-the-world resize the incremental one replaced.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <time.h>
+# include "set.h"
+
+# define INITIAL_SIZE 1000
+
+
+/*
+ * Function:    compareValues
+ *
+ * Description: Compare two integers pointed to by X and Y.
+ */
+
+static int compareValues(int *x, int *y)
+{
+    return (*x > *y) - (*x < *y);
+}
+
+
+/*
+ * Function:    hashValue
+ *
+ * Description: Return a hash value for the integer pointed to by X.
+ */
+
+static unsigned hashValue(int *x)
+{
+    return *x * 2654435761u;
+}
+
+
+/*
+ * Function:    compareTimes
+ *
+ * Description: Compare two times as qsort() expects.
+ */
+
+static int compareTimes(const void *x, const void *y)
+{
+    unsigned a = *(const unsigned *) x, b = *(const unsigned *) y;
+
+    return (a > b) - (a < b);
+}
+
+
+/*
+ * Function:    report
+ *
+ * Description: Sort the N times in TIMES and print their percentiles for
+ *              the insertions that took the set from LO to HI elements.
+ */
+
+static void report(unsigned *times, int n, long lo, long hi)
+{
+    qsort(times, n, sizeof(unsigned), compareTimes);
+    printf("%11ld - %-11ld %8u %8u %8u %10u\n", lo, hi, times[n / 2],
+	times[(long) n * 99 / 100], times[(long) n * 999 / 1000], times[n - 1]);
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    struct timespec start, stop;
+    unsigned *times;
+    int *values, i, n;
+    long lo, hi;
+    SET *sp;
+
+
+    /* Check usage. */
+
+    n = 10000000;
+
+    if (argc == 3 && strcmp(argv[1], "-n") == 0)
+	n = atoi(argv[2]);
+
+    else if (argc != 1) {
+	fprintf(stderr, "usage: %s [-n elements]\n", argv[0]);
+	exit(EXIT_FAILURE);
+    }
+
+    if (n <= INITIAL_SIZE) {
+	fprintf(stderr, "%s: the set must grow past %d elements\n", argv[0],
+	    INITIAL_SIZE);
+	exit(EXIT_FAILURE);
+    }
+
+    values = malloc(sizeof(int) * n);
+    times = malloc(sizeof(unsigned) * n);
+
+    if (values == NULL || times == NULL) {
+	fprintf(stderr, "out of memory\n");
+	exit(EXIT_FAILURE);
+    }
+
+
+    /* Time each insertion on its own. */
+
+    sp = createSet(INITIAL_SIZE, compareValues, hashValue);
+
+    for (i = 0; i < n; i ++) {
+	values[i] = i;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	addElement(sp, &values[i]);
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+	times[i] = (stop.tv_sec - start.tv_sec) * 1000000000L +
+	    stop.tv_nsec - start.tv_nsec;
+    }
+
+
+    /* Report the times for each power of ten. */
+
+    printf("%d insertions, times in nanoseconds\n", n);
+    printf("%25s %8s %8s %8s %10s\n", "elements", "p50", "p99", "p99.9",
+	"max");
+
+    report(times, INITIAL_SIZE, 0, INITIAL_SIZE);
+
+    for (lo = INITIAL_SIZE; lo < n; lo = hi) {
+	hi = lo * 10 < n ? lo * 10 : n;
+	report(times + lo, hi - lo, lo, hi);
+    }
+
+    destroySet(sp);
+    free(values);
+    free(times);
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,109 @@
+/*
+ * File:        parity.c
+ *
+ * Copyright:	2021, Darren C. Atkinson
+ *
+ * Description: This file contains the main function for testing a set
+ *              abstract data type for strings.  It is deliberately stupid.
+ *
+ *              The program takes a single file as a command line argument.
+ *              A set is used to maintain a collection of words that occur
+ *              an odd number of times.  The counts of total words and
+ *              words appearing an odd number of times are printed.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <stdbool.h>
+# include "set.h"
+# include "stats.h"
+
+
+/* This is only an initial size; the set grows as needed. */
+
+# define MAX_SIZE 18000
+
+
+/*
+ * Function:    strhash
+ *
+ * Description: Return a hash value for a string S.
+ */
+
+static unsigned strhash(char *s)
+{
+    unsigned hash = 0;
+
+
+    while (*s != '\0')
+        hash = 31 * hash + *s ++;
+
+    return hash;
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the test application.
+ */
+
+int main(int argc, char *argv[])
+{
+    FILE *fp;
+    char buffer[BUFSIZ], *word;
+    SET *odd;
+    struct setstats stats;
+    int i, words;
+    bool sflag = false;
+
+
+    /* Check usage and open the file. */
+
+    while (argc > 1 && strcmp(argv[1], "-s") == 0) {
+	sflag = true;
+	argc --;
+
+	for (i = 1; i < argc; i ++)
+	    argv[i] = argv[i + 1];
+    }
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s [-s] file1\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    if ((fp = fopen(argv[1], "r")) == NULL) {
+        fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
+        exit(EXIT_FAILURE);
+    }
+
+
+    /* Insert or delete words to compute their parity. */
+
+    words = 0;
+    odd = createSet(MAX_SIZE, strcmp, strhash);
+
+    while (fscanf(fp, "%s", buffer) == 1) {
+        words ++;
+
+        if ((word = findElement(odd, buffer)) != NULL) {
+            removeElement(odd, buffer);
+	    free(word);
+	} else
+            addElement(odd, strdup(buffer));
+    }
+
+    printf("%d total words\n", words);
+    printf("%d words occur an odd number of times\n", numElements(odd));
+    fclose(fp);
+
+    if (sflag) {
+	getSetStats(odd, &stats);
+	printStats(&stats);
+    }
+
+    destroySet(odd);
+    exit(EXIT_SUCCESS);
+}
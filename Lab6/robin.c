@@ -0,0 +1,722 @@
+/*
+ * File:        robin.c
+ *
+ * Author: Riley Heike
+ *
+ * Description: This file contains the public and private function and type
+ *              definitions for a set abstract data type for generic
+ *              pointer types.  A set is an unordered collection of unique
+ *              elements.
+ *
+ *              This implementation uses a hash table with Robin Hood
+ *              hashing: each slot records how far its element is from its
+ *              home slot, and an insertion displaces any element that is
+ *              closer to home than the one being inserted.  This keeps
+ *              probe lengths short and even at high load, lets a search
+ *              stop as soon as it reaches an element closer to home than
+ *              the one being sought, and allows deletion to shift the
+ *              following elements back rather than leave tombstones.
+ *
+ *              It is a drop-in replacement for table.c; the backend is
+ *              chosen by which file the driver is linked against.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <assert.h>
+# include <stdbool.h>
+# include "set.h"
+# include "stats.h"
+# include "sort.h"
+
+# define MIN_LENGTH	16	/* smallest array ever allocated      */
+# define MAX_LOAD	90	/* percent full before growing        */
+# define BATCH_SIZE	16	/* elements prefetched at once        */
+
+# ifdef SETSTATS
+# define COUNT(x)	((x) ++)
+# define RECORD(h, n)	((h)[statBucket(n)] ++)
+# else
+# define COUNT(x)	((void) 0)
+# define RECORD(h, n)	((void) 0)
+# endif
+
+# define HASH(sp, elt)	(COUNT((sp)->stats.hashes), (*(sp)->hash)(elt))
+# define COMPARE(sp, x, y) \
+    (COUNT((sp)->stats.compares), (*(sp)->compare)(x, y))
+
+struct setiter {
+    SET *sp;                    /* set being walked                   */
+    int locn;                   /* next slot to examine               */
+};
+
+struct set {
+    int count;                  /* number of elements in array        */
+    int length;                 /* length of allocated array          */
+    void **data;                /* array of allocated elements        */
+    int *dist;                  /* probe length + 1 of each slot or 0 */
+    int minLength;              /* initial length, never shrunk below */
+    int (*compare)();		/* comparison function                */
+    unsigned (*hash)();		/* hash function                      */
+    struct setiter iter;        /* the set's one iterator             */
+# ifdef SETSTATS
+    struct setstats stats;      /* counters kept as the set is used   */
+# endif
+};
+
+
+/*
+ * Function:    search
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Return the location of ELT, whose hash value is H, in the
+ *		set pointed to by SP.  If the element is present, then
+ *		*FOUND is true.  If not
+ *		present, then *FOUND is false and the location is
+ *		meaningless.  The search stops at the first empty slot or at
+ *		the first element that is closer to its home slot than ELT
+ *		would be, since ELT would have displaced that element.
+ */
+
+static int search(SET *sp, void *elt, unsigned h, bool *found)
+{
+    int d, locn;
+
+
+    locn = h % sp->length;
+
+    for (d = 1; sp->dist[locn] >= d; d ++) {
+	if (COMPARE(sp, sp->data[locn], elt) == 0) {
+	    RECORD(sp->stats.probes, d);
+	    *found = true;
+	    return locn;
+	}
+
+	locn = (locn + 1) % sp->length;
+    }
+
+    RECORD(sp->stats.probes, d);
+    *found = false;
+    return locn;
+}
+
+
+/*
+ * Function:    insert
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Place ELT, which must not already be present, into the set
+ *		pointed to by SP, starting at slot LOCN, which is D - 1
+ *		slots past its home slot and where a search for it stopped.
+ *		Whenever ELT is further from home
+ *		than the element in a slot, the two trade places and the
+ *		displaced element continues the probe.
+ */
+
+static void insert(SET *sp, void *elt, int locn, int d)
+{
+    int tdist;
+    void *temp;
+
+
+    while (sp->dist[locn] != 0) {
+	if (sp->dist[locn] < d) {
+	    temp = sp->data[locn];
+	    tdist = sp->dist[locn];
+	    sp->data[locn] = elt;
+	    sp->dist[locn] = d;
+	    elt = temp;
+	    d = tdist;
+	}
+
+	locn = (locn + 1) % sp->length;
+	d ++;
+    }
+
+    sp->data[locn] = elt;
+    sp->dist[locn] = d;
+}
+
+
+/*
+ * Function:    rehash
+ *
+ * Complexity:  O(m)
+ *
+ * Description: Move every element of the set pointed to by SP into a new
+ *		array of LENGTH slots.
+ */
+
+static void rehash(SET *sp, int length)
+{
+    int i, oldLength, *oldDist;
+    void **oldData;
+
+
+    oldData = sp->data;
+    oldDist = sp->dist;
+    oldLength = sp->length;
+
+    sp->data = malloc(sizeof(void *) * length);
+    assert(sp->data != NULL);
+
+    sp->dist = calloc(length, sizeof(int));
+    assert(sp->dist != NULL);
+
+    sp->length = length;
+
+    for (i = 0; i < oldLength; i ++)
+	if (oldDist[i] != 0)
+	    insert(sp, oldData[i], HASH(sp, oldData[i]) % sp->length, 1);
+
+    free(oldDist);
+    free(oldData);
+}
+
+
+/*
+ * Function:    createSet
+ *
+ * Complexity:  O(m)
+ *
+ * Description: Return a pointer to a new set with an initial capacity of
+ *		MAXELTS.  The set grows and shrinks as elements are added
+ *		and removed, but never shrinks below MAXELTS.
+ */
+
+SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)())
+{
+    SET *sp;
+
+
+    assert(compare != NULL && hash != NULL);
+
+    if (maxElts < MIN_LENGTH)
+	maxElts = MIN_LENGTH;
+
+    sp = malloc(sizeof(SET));
+    assert(sp != NULL);
+
+    sp->data = malloc(sizeof(void *) * maxElts);
+    assert(sp->data != NULL);
+
+    sp->dist = calloc(maxElts, sizeof(int));
+    assert(sp->dist != NULL);
+
+    sp->compare = compare;
+    sp->hash = hash;
+    sp->iter.sp = sp;
+    sp->length = maxElts;
+    sp->minLength = maxElts;
+    sp->count = 0;
+
+# ifdef SETSTATS
+    memset(&sp->stats, 0, sizeof(struct setstats));
+# endif
+
+    return sp;
+}
+
+
+/*
+ * Function:    destroySet
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Deallocate memory associated with the set pointed to by SP.
+ *		The elements themselves are not deallocated.
+ */
+
+void destroySet(SET *sp)
+{
+    assert(sp != NULL);
+
+    free(sp->dist);
+    free(sp->data);
+    free(sp);
+}
+
+
+/*
+ * Function:    numElements
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Return the number of elements in the set pointed to by SP.
+ */
+
+int numElements(SET *sp)
+{
+    assert(sp != NULL);
+    return sp->count;
+}
+
+
+/*
+ * Function:    place
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Add ELT, whose hash value is H and which is not present, to
+ *		the set pointed to by SP, first growing the array if it
+ *		would become more than MAX_LOAD percent full.  LOCN is where
+ *		the search for ELT stopped, so the insertion carries on from
+ *		there rather than probing from the home slot again, unless
+ *		the array was grown.
+ */
+
+static void place(SET *sp, void *elt, unsigned h, int locn)
+{
+    int home;
+
+
+    if ((long) (sp->count + 1) * 100 > (long) sp->length * MAX_LOAD) {
+	rehash(sp, sp->length * 2);
+	locn = h % sp->length;
+    }
+
+    home = h % sp->length;
+    insert(sp, elt, locn, (locn - home + sp->length) % sp->length + 1);
+    sp->count ++;
+}
+
+
+/*
+ * Function:    add
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Add ELT, whose hash value is H, to the set pointed to by SP
+ *		unless an equal element is present.  Return whichever
+ *		element is in the set afterwards.
+ */
+
+static void *add(SET *sp, void *elt, unsigned h)
+{
+    int locn;
+    bool found;
+
+
+    locn = search(sp, elt, h, &found);
+
+    if (found)
+	return sp->data[locn];
+
+    place(sp, elt, h, locn);
+    return elt;
+}
+
+
+/*
+ * Function:    erase
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Remove the element in slot LOCN of the set pointed to by SP
+ *		and return it.  Each following element that is not in its
+ *		home slot is shifted back by one slot, so no tombstone is
+ *		left behind.  The array is shrunk once it is less than an
+ *		eighth full.
+ */
+
+static void *erase(SET *sp, int locn)
+{
+    int next;
+    void *elt;
+
+
+    elt = sp->data[locn];
+    next = (locn + 1) % sp->length;
+
+    while (sp->dist[next] > 1) {
+	sp->data[locn] = sp->data[next];
+	sp->dist[locn] = sp->dist[next] - 1;
+	locn = next;
+	next = (next + 1) % sp->length;
+    }
+
+    sp->dist[locn] = 0;
+    sp->count --;
+
+    if (sp->count < sp->length / 8 && sp->length / 2 >= sp->minLength)
+	rehash(sp, sp->length / 2);
+
+    return elt;
+}
+
+
+/*
+ * Function:    prefetch
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Ask the processor to start loading the home slot for the
+ *		hash value H in the set pointed to by SP.
+ */
+
+static void prefetch(SET *sp, unsigned h)
+{
+    int locn;
+
+
+    locn = h % sp->length;
+
+    __builtin_prefetch(&sp->dist[locn]);
+    __builtin_prefetch(&sp->data[locn]);
+}
+
+
+/*
+ * Function:    addElement
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Add ELT to the set pointed to by SP.
+ */
+
+void addElement(SET *sp, void *elt)
+{
+    assert(sp != NULL && elt != NULL);
+    add(sp, elt, HASH(sp, elt));
+}
+
+
+/*
+ * Function:    removeElement
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Remove ELT from the set pointed to by SP.
+ */
+
+void removeElement(SET *sp, void *elt)
+{
+    int locn;
+    bool found;
+
+
+    assert(sp != NULL && elt != NULL);
+    locn = search(sp, elt, HASH(sp, elt), &found);
+
+    if (found)
+	erase(sp, locn);
+}
+
+
+/*
+ * Function:    findOrAddElement
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Return the element equal to ELT in the set pointed to by
+ *		SP, adding ELT if there is none, and set *INSERTED, if it
+ *		is not NULL, to whether ELT was added.
+ */
+
+void *findOrAddElement(SET *sp, void *elt, bool *inserted)
+{
+    int count;
+    void *found;
+
+
+    assert(sp != NULL && elt != NULL);
+
+    count = sp->count;
+    found = add(sp, elt, HASH(sp, elt));
+
+    if (inserted != NULL)
+	*inserted = sp->count != count;
+
+    return found;
+}
+
+
+/*
+ * Function:    toggleElement
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Remove the element equal to ELT from the set pointed to by
+ *		SP and return it, or add ELT and return NULL if there is
+ *		none.  Either way the slot where the search stopped is
+ *		where the change starts, so ELT is only searched for once.
+ */
+
+void *toggleElement(SET *sp, void *elt)
+{
+    int locn;
+    bool found;
+    unsigned h;
+
+
+    assert(sp != NULL && elt != NULL);
+
+    h = HASH(sp, elt);
+    locn = search(sp, elt, h, &found);
+
+    if (found)
+	return erase(sp, locn);
+
+    place(sp, elt, h, locn);
+    return NULL;
+}
+
+
+/*
+ * Function:    findElement
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: If ELT is present in the set pointed to by SP then return
+ *		it, otherwise return NULL.
+ */
+
+void *findElement(SET *sp, void *elt)
+{
+    int locn;
+    bool found;
+
+
+    assert(sp != NULL && elt != NULL);
+
+    locn = search(sp, elt, HASH(sp, elt), &found);
+    return found ? sp->data[locn] : NULL;
+}
+
+
+/*
+ * Function:    findElements
+ *
+ * Complexity:  O(n) average case
+ *
+ * Description: Search the set pointed to by SP for each of the N elements
+ *		in ELTS, storing the element found or NULL in the same
+ *		position of FOUND.  The elements are hashed and their home
+ *		slots prefetched BATCH_SIZE at a time before any is
+ *		searched, so that their cache misses overlap.
+ */
+
+void findElements(SET *sp, void **elts, int n, void **found)
+{
+    int i, j, m, locn;
+    unsigned h[BATCH_SIZE];
+    bool present;
+
+
+    assert(sp != NULL && elts != NULL && found != NULL);
+
+    for (i = 0; i < n; i += BATCH_SIZE) {
+	m = n - i < BATCH_SIZE ? n - i : BATCH_SIZE;
+
+	for (j = 0; j < m; j ++) {
+	    h[j] = HASH(sp, elts[i + j]);
+	    prefetch(sp, h[j]);
+	}
+
+	for (j = 0; j < m; j ++) {
+	    locn = search(sp, elts[i + j], h[j], &present);
+	    found[i + j] = present ? sp->data[locn] : NULL;
+	}
+    }
+}
+
+
+/*
+ * Function:    addElements
+ *
+ * Complexity:  O(n) average case
+ *
+ * Description: Add each of the N elements in ELTS to the set pointed to by
+ *		SP, hashing and prefetching them in batches as in
+ *		findElements.  If FOUND is not NULL, the element in the set
+ *		afterwards is stored in the same position of FOUND; it
+ *		differs from the element given when an equal element was
+ *		already present, including one earlier in ELTS.
+ */
+
+void addElements(SET *sp, void **elts, int n, void **found)
+{
+    int i, j, m;
+    unsigned h[BATCH_SIZE];
+    void *elt;
+
+
+    assert(sp != NULL && elts != NULL);
+
+    for (i = 0; i < n; i += BATCH_SIZE) {
+	m = n - i < BATCH_SIZE ? n - i : BATCH_SIZE;
+
+	for (j = 0; j < m; j ++) {
+	    assert(elts[i + j] != NULL);
+	    h[j] = HASH(sp, elts[i + j]);
+	    prefetch(sp, h[j]);
+	}
+
+	for (j = 0; j < m; j ++) {
+	    elt = add(sp, elts[i + j], h[j]);
+
+	    if (found != NULL)
+		found[i + j] = elt;
+	}
+    }
+}
+
+
+/*
+ * Function:    compactSet
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Remove any deleted slots from the set pointed to by SP.
+ *		Deletion never leaves any behind, so there is nothing to do.
+ */
+
+void compactSet(SET *sp)
+{
+    assert(sp != NULL);
+}
+
+
+/*
+ * Function:	getElements
+ *
+ * Complexity:	O(m)
+ *
+ * Description:	Allocate and return an array of elements in the set pointed
+ *		to by SP, in sorted order.
+ */
+
+void *getElements(SET *sp)
+{
+    int i, j;
+    void **elts;
+
+
+    assert(sp != NULL);
+
+    elts = malloc(sizeof(void *) * sp->count);
+    assert(elts != NULL);
+
+    for (i = 0, j = 0; i < sp->length; i ++)
+	if (sp->dist[i] != 0)
+	    elts[j ++] = sp->data[i];
+
+    quickSort(elts, 0, sp->count-1, sp->compare);
+
+    return elts;
+}
+
+/*
+ * Function:    beginSet
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Start the iterator of the set pointed to by SP over at
+ *		the first slot and return it.
+ */
+
+SETITER *beginSet(SET *sp)
+{
+    assert(sp != NULL);
+
+    sp->iter.locn = 0;
+    return &sp->iter;
+}
+
+
+/*
+ * Function:    nextElement
+ *
+ * Complexity:  O(1) average case
+ *
+ * Description: Return the next element of the walk by the iterator
+ *		pointed to by IT, or NULL once every element has been
+ *		returned.
+ */
+
+void *nextElement(SETITER *it)
+{
+    SET *sp;
+
+
+    assert(it != NULL);
+    sp = it->sp;
+
+    while (it->locn < sp->length)
+	if (sp->dist[it->locn ++] != 0)
+	    return sp->data[it->locn - 1];
+
+    return NULL;
+}
+
+
+/*
+ * Function:    forEachElement
+ *
+ * Complexity:  O(m)
+ *
+ * Description: Call FN with each element in the set pointed to by SP and
+ *		CTX, in the order they are stored.
+ */
+
+void forEachElement(SET *sp, void (*fn)(), void *ctx)
+{
+    int i;
+
+
+    assert(sp != NULL && fn != NULL);
+
+    for (i = 0; i < sp->length; i ++)
+	if (sp->dist[i] != 0)
+	    (*fn)(sp->data[i], ctx);
+}
+
+
+
+/*
+ * Function:    getSetStats
+ *
+ * Complexity:  O(m)
+ *
+ * Description: Fill in the statistics pointed to by STATS for the set
+ *		pointed to by SP.  A run is a stretch of slots that are not
+ *		empty.  Deletion shifts elements back, so there are never
+ *		any tombstones.
+ */
+
+void getSetStats(SET *sp, struct setstats *stats)
+{
+    int i, run;
+
+
+    assert(sp != NULL && stats != NULL);
+
+    memset(stats, 0, sizeof(struct setstats));
+    stats->count = sp->count;
+    stats->length = sp->length;
+    stats->bytes = sizeof(SET) + (sizeof(void *) + sizeof(int)) * sp->length;
+
+    for (i = 0, run = 0; i < sp->length; i ++) {
+	if (sp->dist[i] != 0)
+	    run ++;
+	else if (run > 0) {
+	    stats->chains[statBucket(run)] ++;
+	    run = 0;
+	}
+    }
+
+    if (run > 0)
+	stats->chains[statBucket(run)] ++;
+
+# ifdef SETSTATS
+    stats->compares = sp->stats.compares;
+    stats->hashes = sp->stats.hashes;
+    memcpy(stats->probes, sp->stats.probes, sizeof(stats->probes));
+# else
+    stats->compares = -1;
+    stats->hashes = -1;
+# endif
+}
@@ -12,8 +12,35 @@
 # ifndef SET_H
 # define SET_H
 
+# include <stddef.h>
+# include <stdbool.h>
+
 typedef struct set SET;
 
+typedef struct setiter SETITER;
+
+/*
+ * Statistics about a set.  A histogram counts lengths by powers of two:
+ * bucket 0 counts lengths of zero and bucket k counts lengths from
+ * 2^(k-1) to 2^k - 1.  The compare and hash counts and the histogram of
+ * probes are only kept if the set is compiled with -DSETSTATS; otherwise
+ * the counts are -1 and the histogram is empty, and the set does no extra
+ * work.  The other fields are worked out when the statistics are asked for.
+ */
+
+# define STAT_BUCKETS 32
+
+struct setstats {
+    int count;                  /* number of elements                  */
+    int length;                 /* number of slots or buckets          */
+    int tombstones;             /* deleted slots not yet reused        */
+    size_t bytes;               /* bytes allocated by the set          */
+    long compares;              /* calls to the compare function       */
+    long hashes;                /* calls to the hash function          */
+    long probes[STAT_BUCKETS];  /* searches by elements examined       */
+    long chains[STAT_BUCKETS];  /* filled runs or chains by length     */
+};
+
 SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)());
 
 void destroySet(SET *sp);
@@ -26,6 +53,40 @@ void removeElement(SET *sp, void *elt);
 
 void *findElement(SET *sp, void *elt);
 
+void findElements(SET *sp, void **elts, int n, void **found);
+
+void addElements(SET *sp, void **elts, int n, void **found);
+
 void *getElements(SET *sp);
 
+/*
+ * findOrAddElement returns the element equal to ELT, adding ELT if there
+ * was none, and sets *INSERTED, if given, to whether it was added.
+ * toggleElement adds ELT if no equal element is there and returns NULL,
+ * and otherwise removes the equal element and returns it, so the caller
+ * can free it.  Each looks for ELT only once.
+ */
+
+void *findOrAddElement(SET *sp, void *elt, bool *inserted);
+
+void *toggleElement(SET *sp, void *elt);
+
+void compactSet(SET *sp);
+
+void getSetStats(SET *sp, struct setstats *stats);
+
+/*
+ * An iterator walks the elements of a set where they are stored, so that
+ * they can be visited without copying them into an array.  Each set has
+ * a single iterator, and beginSet starts it over, so only one walk of a
+ * set can be under way at once.  The set must not be changed during a
+ * walk.  forEachElement calls FN with each element and CTX in turn.
+ */
+
+SETITER *beginSet(SET *sp);
+
+void *nextElement(SETITER *it);
+
+void forEachElement(SET *sp, void (*fn)(), void *ctx);
+
 # endif /* SET_H */
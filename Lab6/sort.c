@@ -0,0 +1,453 @@
+/*
+ * File:        sort.c
+ *
+ * Author: Riley Heike
+ *
+ * Description: This file contains the function definitions for sorting
+ *              an array of generic pointer types using a comparison
+ *              function.  It is shared by each of the set
+ *              implementations, whose getElements returns the elements
+ *              in sorted order.
+ *
+ *              The sort is a pattern-defeating quicksort.  The pivot is
+ *              the median of three elements, or of nine for larger
+ *              ranges, so sorted and reverse sorted input split evenly.
+ *              Short ranges are finished with insertion sort.  A
+ *              partition that moved nothing is assumed to be nearly
+ *              sorted already and is tried with an insertion sort that
+ *              gives up after a few moves.  Runs of elements equal to an
+ *              earlier pivot are split off in one pass.  A badly
+ *              unbalanced partition has a few elements swapped to break
+ *              up whatever pattern caused it, and a range that keeps
+ *              partitioning badly is heap sorted, so the worst case is
+ *              O(n log n).  Only the smaller side of each partition is
+ *              sorted recursively, so the stack depth is O(log n).
+ *
+ *              Arrays of at least PARALLEL_SIZE elements are sorted by
+ *              several threads: after a partition, one side is handed to
+ *              a new thread while the current one goes on with the other,
+ *              until there is a thread for each processor.
+ */
+
+# include <stdbool.h>
+# include <pthread.h>
+# include <unistd.h>
+# include "sort.h"
+
+# define INSERTION_SIZE	24	/* ranges shorter than this use insertion sort */
+# define NINTHER_SIZE	128	/* ranges longer than this use a ninther       */
+# define PARTIAL_LIMIT	8	/* moves before a partial insertion gives up   */
+# define PARALLEL_SIZE	65536	/* smallest range handed to another thread     */
+# define MAX_THREADS	64	/* most threads used for one sort              */
+# define MAX_SPAWNS	8	/* most threads started by one call of sort    */
+
+struct task {
+	void **data;
+	int lo, hi;
+	int (*compare)();
+	int limit;
+	bool leftmost;
+	int threads;
+};
+
+static void sort(void **data, int lo, int hi, int (*compare)(), int limit,
+	bool leftmost, int threads);
+
+/*
+ * Function: Swap
+ *
+ * Complexity: O(1)
+ *
+ * Description: Swaps two values
+ *
+ */
+
+static void swap(void **a, void **b){
+
+	void* temp;
+	temp = *a;
+	*a = *b;
+	*b = temp;
+
+}
+
+/*
+ * Function: Sort Three
+ *
+ * Complexity: O(1)
+ *
+ * Description: Puts the elements at a, b and c in order
+ *
+ */
+
+static void sortThree(void **data, int a, int b, int c, int (*compare)()){
+
+	if((*compare)(data[b], data[a]) < 0) swap(&data[a], &data[b]);
+	if((*compare)(data[c], data[b]) < 0) swap(&data[b], &data[c]);
+	if((*compare)(data[b], data[a]) < 0) swap(&data[a], &data[b]);
+
+}
+
+/*
+ * Function: Insertion Sort
+ *
+ * Complexity: O(n^2), O(n) if nearly sorted
+ *
+ * Description: Sorts data[lo..hi] by inserting each element
+ * into the sorted elements before it
+ *
+ */
+
+static void insertionSort(void **data, int lo, int hi, int (*compare)()){
+
+	int i, j;
+	void *x;
+
+	for(i = lo+1; i <= hi; i++){
+
+		x = data[i];
+		for(j = i; j > lo && (*compare)(x, data[j-1]) < 0; j--)
+			data[j] = data[j-1];
+		data[j] = x;
+
+	}
+
+}
+
+/*
+ * Function: Partial Insertion Sort
+ *
+ * Complexity: O(n)
+ *
+ * Description: Insertion sorts data[lo..hi] unless it would
+ * take more than PARTIAL_LIMIT moves, in which case it stops
+ * and returns false. The range is left a permutation of what
+ * it was either way
+ *
+ */
+
+static bool partialInsertionSort(void **data, int lo, int hi, int (*compare)()){
+
+	int i, j, moves = 0;
+	void *x;
+
+	for(i = lo+1; i <= hi; i++){
+
+		x = data[i];
+		for(j = i; j > lo && (*compare)(x, data[j-1]) < 0; j--)
+			data[j] = data[j-1];
+		data[j] = x;
+
+		moves += i - j;
+		if(moves > PARTIAL_LIMIT) return i == hi;
+
+	}
+
+	return true;
+
+}
+
+/*
+ * Function: Sift Down
+ *
+ * Complexity: O(log n)
+ *
+ * Description: Moves element i of the heap of n elements
+ * starting at base down until it is no smaller than its
+ * children
+ *
+ */
+
+static void siftDown(void **base, int i, int n, int (*compare)()){
+
+	int child;
+
+	while((child = 2*i + 1) < n){
+
+		if(child+1 < n && (*compare)(base[child], base[child+1]) < 0) child++;
+		if((*compare)(base[i], base[child]) >= 0) return;
+
+		swap(&base[i], &base[child]);
+		i = child;
+
+	}
+
+}
+
+/*
+ * Function: Heap Sort
+ *
+ * Complexity: O(n logn)
+ *
+ * Description: Sorts data[lo..hi] with a heap, used when a
+ * range keeps partitioning badly
+ *
+ */
+
+static void heapSort(void **data, int lo, int hi, int (*compare)()){
+
+	void **base = data + lo;
+	int n = hi - lo + 1;
+	int i;
+
+	for(i = n/2 - 1; i >= 0; i--) siftDown(base, i, n, compare);
+
+	for(i = n-1; i > 0; i--){
+
+		swap(&base[0], &base[i]);
+		siftDown(base, 0, i, compare);
+
+	}
+
+}
+
+/*
+ * Function: Partition Right
+ *
+ * Complexity: O(n)
+ *
+ * Decription: Partitions data[lo..hi] around the pivot at
+ * data[lo], so the elements less than it come before it and
+ * the rest after, and returns where the pivot ends up. Sets
+ * already if no elements had to be exchanged
+ *
+ */
+
+static int partitionRight(void **data, int lo, int hi, int (*compare)(),
+	bool *already){
+
+	void *pivot = data[lo];
+	int i = lo, j = hi+1;
+
+	while(++i <= hi && (*compare)(data[i], pivot) < 0);
+	while(--j > lo && (*compare)(data[j], pivot) >= 0);
+
+	*already = i >= j;
+
+	while(i < j){
+
+		swap(&data[i], &data[j]);
+		while((*compare)(data[++i], pivot) < 0);
+		while((*compare)(data[--j], pivot) >= 0);
+
+	}
+
+	swap(&data[lo], &data[j]);
+	return j;
+
+}
+
+/*
+ * Function: Partition Left
+ *
+ * Complexity: O(n)
+ *
+ * Decription: Partitions data[lo..hi] around the pivot at
+ * data[lo], so the elements no greater than it come before
+ * it and the rest after, and returns where the pivot ends
+ * up. Used when the pivot equals an earlier pivot that is
+ * no greater than anything in the range, so every element
+ * before it is equal to it and needs no more sorting
+ *
+ */
+
+static int partitionLeft(void **data, int lo, int hi, int (*compare)()){
+
+	void *pivot = data[lo];
+	int i = lo, j = hi+1;
+
+	while((*compare)(pivot, data[--j]) < 0);
+	while(i < j && (*compare)(pivot, data[++i]) >= 0);
+
+	while(i < j){
+
+		swap(&data[i], &data[j]);
+		while((*compare)(pivot, data[--j]) < 0);
+		while((*compare)(pivot, data[++i]) >= 0);
+
+	}
+
+	swap(&data[lo], &data[j]);
+	return j;
+
+}
+
+/*
+ * Function: Run
+ *
+ * Complexity: O(n logn)
+ *
+ * Description: Sorts the range described by a task, as the
+ * start routine of a thread
+ *
+ */
+
+static void *run(void *arg){
+
+	struct task *tp = arg;
+	sort(tp->data, tp->lo, tp->hi, tp->compare, tp->limit, tp->leftmost,
+		tp->threads);
+	return NULL;
+
+}
+
+/*
+ * Function: Sort
+ *
+ * Complexity: O(n logn)
+ *
+ * Description: Sorts data[lo..hi]. Limit is how many more
+ * bad partitions are allowed before falling back to heap
+ * sort, and leftmost is whether the range starts the whole
+ * array, since otherwise data[lo-1] is an earlier pivot no
+ * greater than anything in the range. Up to threads threads
+ * may be used, and any started here are joined before it
+ * returns
+ *
+ */
+
+static void sort(void **data, int lo, int hi, int (*compare)(), int limit,
+	bool leftmost, int threads){
+
+	struct task tasks[MAX_SPAWNS];
+	pthread_t tids[MAX_SPAWNS];
+	int ntasks = 0;
+	int n, mid, p, lsize, rsize;
+	bool already;
+
+	while((n = hi - lo + 1) >= INSERTION_SIZE){
+
+		mid = lo + n/2;
+
+		if(n > NINTHER_SIZE){
+
+			sortThree(data, lo, mid, hi, compare);
+			sortThree(data, lo+1, mid-1, hi-1, compare);
+			sortThree(data, lo+2, mid+1, hi-2, compare);
+			sortThree(data, mid-1, mid, mid+1, compare);
+
+		}
+
+		else sortThree(data, lo, mid, hi, compare);
+
+		swap(&data[lo], &data[mid]);
+
+		if(!leftmost && (*compare)(data[lo-1], data[lo]) >= 0){
+
+			lo = partitionLeft(data, lo, hi, compare) + 1;
+			continue;
+
+		}
+
+		p = partitionRight(data, lo, hi, compare, &already);
+		lsize = p - lo;
+		rsize = hi - p;
+
+		if(lsize < n/8 || rsize < n/8){
+
+			if(--limit == 0){
+
+				heapSort(data, lo, hi, compare);
+				break;
+
+			}
+
+			if(lsize >= INSERTION_SIZE){
+
+				swap(&data[lo], &data[lo + lsize/4]);
+				swap(&data[p-1], &data[p - lsize/4]);
+
+			}
+
+			if(rsize >= INSERTION_SIZE){
+
+				swap(&data[p+1], &data[p+1 + rsize/4]);
+				swap(&data[hi], &data[hi - rsize/4]);
+
+			}
+
+		}
+
+		else if(already && partialInsertionSort(data, lo, p-1, compare) &&
+				partialInsertionSort(data, p+1, hi, compare))
+			break;
+
+		if(threads > 1 && lsize >= PARALLEL_SIZE && rsize >= PARALLEL_SIZE &&
+				ntasks < MAX_SPAWNS){
+
+			struct task *tp = &tasks[ntasks];
+			tp->data = data;
+			tp->lo = lo;
+			tp->hi = p-1;
+			tp->compare = compare;
+			tp->limit = limit;
+			tp->leftmost = leftmost;
+			tp->threads = threads/2;
+
+			if(pthread_create(&tids[ntasks], NULL, run, tp) == 0){
+
+				ntasks++;
+				threads -= threads/2;
+				lo = p+1;
+				leftmost = false;
+				continue;
+
+			}
+
+		}
+
+		if(lsize < rsize){
+
+			sort(data, lo, p-1, compare, limit, leftmost, 1);
+			lo = p+1;
+			leftmost = false;
+
+		}
+
+		else{
+
+			sort(data, p+1, hi, compare, limit, false, 1);
+			hi = p-1;
+
+		}
+
+	}
+
+	if(n < INSERTION_SIZE) insertionSort(data, lo, hi, compare);
+
+	while(ntasks > 0) pthread_join(tids[--ntasks], NULL);
+
+}
+
+/*
+ * Function: Quick Sort
+ *
+ * Complexity: O(n logn)
+ *
+ * Description: Sorts data[lo..hi] using the comparison
+ * function, with one thread per processor if the range
+ * holds at least PARALLEL_SIZE elements
+ *
+ */
+
+void quickSort(void **data, int lo, int hi, int(*compare)()){
+
+	int n = hi - lo + 1;
+	int limit = 1;
+	int threads = 1;
+	long cpus;
+
+	if(n < 2) return;
+
+	while(n >> limit) limit++;
+
+	if(n >= PARALLEL_SIZE){
+
+		cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = cpus < 1 ? 1 : cpus > MAX_THREADS ? MAX_THREADS : cpus;
+
+	}
+
+	sort(data, lo, hi, compare, limit, true, threads);
+
+}
@@ -0,0 +1,15 @@
+/*
+ * File:        sort.h
+ *
+ * Author: Riley Heike
+ *
+ * Description: This file contains the public function declarations for
+ *              sorting an array of generic pointer types.
+ */
+
+# ifndef SORT_H
+# define SORT_H
+
+void quickSort(void **data, int lo, int hi, int (*compare)());
+
+# endif /* SORT_H */
@@ -0,0 +1,66 @@
+/*
+ * File:        stats.c
+ *
+ * Author:      Riley Heike
+ *
+ * Description: This file contains the function definitions for the
+ *              statistics of a set that are not part of any one
+ *              implementation: the histogram bucket of a length, used by
+ *              every set, and a function for the programs to print them.
+ */
+
+# include <stdio.h>
+# include "stats.h"
+
+
+/*
+ * Function:    statBucket
+ *
+ * Complexity:  O(log n)
+ *
+ * Description: Return the histogram bucket for a length N, which is 0 for
+ *		N = 0 and K for 2^(K-1) <= N < 2^K.
+ */
+
+int statBucket(long n)
+{
+    int k;
+
+
+    for (k = 0; n > 0 && k < STAT_BUCKETS - 1; k ++)
+	n >>= 1;
+
+    return k;
+}
+
+
+/*
+ * Function:    printStats
+ *
+ * Description: Print the statistics STATS on standard error, with a row
+ *		for each histogram bucket that counted anything.
+ */
+
+void printStats(struct setstats *stats)
+{
+    int i;
+
+
+    fprintf(stderr, "%d elements in %d slots, %d tombstones, %lu bytes\n",
+	stats->count, stats->length, stats->tombstones,
+	(unsigned long) stats->bytes);
+
+    if (stats->compares < 0)
+	fprintf(stderr, "compares and probes not counted without SETSTATS\n");
+    else
+	fprintf(stderr, "%ld compares, %ld hashes\n", stats->compares,
+	    stats->hashes);
+
+    fprintf(stderr, "%15s %12s %12s\n", "length", "searches", "runs");
+
+    for (i = 0; i < STAT_BUCKETS; i ++)
+	if (stats->probes[i] > 0 || stats->chains[i] > 0)
+	    fprintf(stderr, "%7ld - %-5ld %12ld %12ld\n",
+		i > 0 ? 1L << (i - 1) : 0L, i > 0 ? (1L << i) - 1 : 0L,
+		stats->probes[i], stats->chains[i]);
+}
@@ -0,0 +1,821 @@
+/*
+ * File:        swiss.c
+ *
+ * Author: Riley Heike
+ *
+ * Description: This file contains the public and private function and type
+ *              definitions for a set abstract data type for generic
+ *              pointer types.  A set is an unordered collection of unique
+ *              elements.
+ *
+ *              This implementation uses an open addressing hash table whose
+ *              slots are grouped sixteen at a time.  Alongside the elements
+ *              is an array of control bytes: a full slot holds the low
+ *              seven bits of its element's hash, and an empty or deleted
+ *              slot holds a value with the high bit set.  A search compares
+ *              all sixteen control bytes of a group at once using SSE2, and
+ *              only calls the comparison function on slots whose hash bits
+ *              match, so most misses never compare an element at all.
+ *
+ *              It is a drop-in replacement for table.c; the backend is
+ *              chosen by which file the driver is linked against.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <assert.h>
+# include <stdbool.h>
+# include "set.h"
+# include "stats.h"
+# include "sort.h"
+
+# ifdef __SSE2__
+# include <emmintrin.h>
+# endif
+
+# define GROUP_SIZE	16	/* slots examined at once             */
+# define MIN_GROUPS	1	/* smallest number of groups          */
+# define BATCH_SIZE	16	/* elements prefetched at once        */
+
+# define EMPTY		((signed char) -128)
+# define DELETED	((signed char) -2)
+
+# ifdef SETSTATS
+# define COUNT(x)	((x) ++)
+# define RECORD(h, n)	((h)[statBucket(n)] ++)
+# else
+# define COUNT(x)	((void) 0)
+# define RECORD(h, n)	((void) 0)
+# endif
+
+# define HASH(sp, elt)	(COUNT((sp)->stats.hashes), (*(sp)->hash)(elt))
+# define COMPARE(sp, x, y) \
+    (COUNT((sp)->stats.compares), (*(sp)->compare)(x, y))
+
+struct setiter {
+    SET *sp;                    /* set being walked                   */
+    int locn;                   /* next slot to examine               */
+};
+
+struct set {
+    int count;                  /* number of elements in array        */
+    int deleted;                /* number of deleted slots            */
+    int length;                 /* length of allocated array          */
+    int groups;                 /* number of groups of slots          */
+    void **data;                /* array of allocated elements        */
+    signed char *ctrl;          /* control byte of each slot          */
+    int minGroups;              /* initial groups, never shrunk below */
+    int (*compare)();		/* comparison function                */
+    unsigned (*hash)();		/* hash function                      */
+    struct setiter iter;        /* the set's one iterator             */
+# ifdef SETSTATS
+    struct setstats stats;      /* counters kept as the set is used   */
+# endif
+};
+
+
+/*
+ * Function:    matchByte
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Return a mask with bit i set if the ith control byte of the
+ *		group starting at CTRL is equal to BYTE.
+ */
+
+static unsigned matchByte(signed char *ctrl, signed char byte)
+{
+# ifdef __SSE2__
+    __m128i group = _mm_loadu_si128((__m128i *) ctrl);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(byte)));
+# else
+    int i;
+    unsigned mask = 0;
+
+    for (i = 0; i < GROUP_SIZE; i ++)
+	if (ctrl[i] == byte)
+	    mask |= 1u << i;
+
+    return mask;
+# endif
+}
+
+
+/*
+ * Function:    matchFree
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Return a mask with bit i set if the ith slot of the group
+ *		starting at CTRL is empty or deleted, which are exactly the
+ *		control bytes with the high bit set.
+ */
+
+static unsigned matchFree(signed char *ctrl)
+{
+# ifdef __SSE2__
+    return _mm_movemask_epi8(_mm_loadu_si128((__m128i *) ctrl));
+# else
+    int i;
+    unsigned mask = 0;
+
+    for (i = 0; i < GROUP_SIZE; i ++)
+	if (ctrl[i] < 0)
+	    mask |= 1u << i;
+
+    return mask;
+# endif
+}
+
+
+/*
+ * Function:    search
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Return the location of ELT, whose hash value is H, in the
+ *		set pointed to by SP.  If the element is present, then
+ *		*FOUND is true.  If not
+ *		present, then *FOUND is false and the first free slot along
+ *		the probe sequence is returned.  Groups are probed in order
+ *		starting from the home group, and the search stops at the
+ *		first group that contains an empty slot.
+ */
+
+static int search(SET *sp, void *elt, unsigned h, bool *found)
+{
+    int available, g, i, locn;
+    unsigned mask;
+    signed char *ctrl;
+
+
+    g = (h >> 7) % sp->groups;
+    available = -1;
+
+    for (i = 0; i < sp->groups; i ++) {
+	ctrl = sp->ctrl + g * GROUP_SIZE;
+
+	for (mask = matchByte(ctrl, h & 0x7f); mask != 0; mask &= mask - 1) {
+	    locn = g * GROUP_SIZE + __builtin_ctz(mask);
+
+	    if (COMPARE(sp, sp->data[locn], elt) == 0) {
+		RECORD(sp->stats.probes, i + 1);
+		*found = true;
+		return locn;
+	    }
+	}
+
+	mask = matchFree(ctrl);
+
+	if (mask != 0 && available == -1)
+	    available = g * GROUP_SIZE + __builtin_ctz(mask);
+
+	if (matchByte(ctrl, EMPTY) != 0)
+	    break;
+
+	g = (g + 1) % sp->groups;
+    }
+
+    RECORD(sp->stats.probes, i < sp->groups ? i + 1 : i);
+    *found = false;
+    return available;
+}
+
+
+/*
+ * Function:    fill
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Put ELT, whose hash value is H, in the free slot LOCN of
+ *		the set pointed to by SP.
+ */
+
+static void fill(SET *sp, int locn, void *elt, unsigned h)
+{
+    if (sp->ctrl[locn] == DELETED)
+	sp->deleted --;
+
+    sp->data[locn] = elt;
+    sp->ctrl[locn] = h & 0x7f;
+}
+
+
+/*
+ * Function:    insert
+ *
+ * Complexity:  O(1) average case
+ *
+ * Description: Place ELT, which must not already be present, into the
+ *		first free slot along its probe sequence in the set pointed
+ *		to by SP, reusing the hash value H.
+ */
+
+static void insert(SET *sp, void *elt, unsigned h)
+{
+    int g;
+    unsigned mask;
+
+
+    g = (h >> 7) % sp->groups;
+
+    while ((mask = matchFree(sp->ctrl + g * GROUP_SIZE)) == 0)
+	g = (g + 1) % sp->groups;
+
+    fill(sp, g * GROUP_SIZE + __builtin_ctz(mask), elt, h);
+}
+
+
+/*
+ * Function:    rehash
+ *
+ * Complexity:  O(m)
+ *
+ * Description: Move every element of the set pointed to by SP into a new
+ *		array of GROUPS groups, discarding any deleted slots.
+ */
+
+static void rehash(SET *sp, int groups)
+{
+    int i, oldLength;
+    void **oldData;
+    signed char *oldCtrl;
+
+
+    oldData = sp->data;
+    oldCtrl = sp->ctrl;
+    oldLength = sp->length;
+
+    sp->groups = groups;
+    sp->length = groups * GROUP_SIZE;
+    sp->deleted = 0;
+
+    sp->data = malloc(sizeof(void *) * sp->length);
+    assert(sp->data != NULL);
+
+    sp->ctrl = malloc(sp->length);
+    assert(sp->ctrl != NULL);
+    memset(sp->ctrl, EMPTY, sp->length);
+
+    for (i = 0; i < oldLength; i ++)
+	if (oldCtrl[i] >= 0)
+	    insert(sp, oldData[i], HASH(sp, oldData[i]));
+
+    free(oldCtrl);
+    free(oldData);
+}
+
+
+/*
+ * Function:    createSet
+ *
+ * Complexity:  O(m)
+ *
+ * Description: Return a pointer to a new set with an initial capacity of
+ *		at least MAXELTS.  The set grows and shrinks as elements are
+ *		added and removed, but never shrinks below its initial size.
+ */
+
+SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)())
+{
+    SET *sp;
+
+
+    assert(compare != NULL && hash != NULL);
+
+    sp = malloc(sizeof(SET));
+    assert(sp != NULL);
+
+    sp->groups = (maxElts + GROUP_SIZE - 1) / GROUP_SIZE;
+
+    if (sp->groups < MIN_GROUPS)
+	sp->groups = MIN_GROUPS;
+
+    sp->length = sp->groups * GROUP_SIZE;
+
+    sp->data = malloc(sizeof(void *) * sp->length);
+    assert(sp->data != NULL);
+
+    sp->ctrl = malloc(sp->length);
+    assert(sp->ctrl != NULL);
+    memset(sp->ctrl, EMPTY, sp->length);
+
+    sp->compare = compare;
+    sp->hash = hash;
+    sp->iter.sp = sp;
+    sp->minGroups = sp->groups;
+    sp->count = 0;
+    sp->deleted = 0;
+
+# ifdef SETSTATS
+    memset(&sp->stats, 0, sizeof(struct setstats));
+# endif
+
+    return sp;
+}
+
+
+/*
+ * Function:    destroySet
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Deallocate memory associated with the set pointed to by SP.
+ *		The elements themselves are not deallocated.
+ */
+
+void destroySet(SET *sp)
+{
+    assert(sp != NULL);
+
+    free(sp->ctrl);
+    free(sp->data);
+    free(sp);
+}
+
+
+/*
+ * Function:    numElements
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Return the number of elements in the set pointed to by SP.
+ */
+
+int numElements(SET *sp)
+{
+    assert(sp != NULL);
+    return sp->count;
+}
+
+
+/*
+ * Function:    place
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Add ELT, whose hash value is H and which is not present, to
+ *		the set pointed to by SP.  LOCN is the free slot returned by
+ *		the search for ELT, which is where insert would put it, so
+ *		it is used directly.  If full and deleted slots would fill
+ *		more than seven eighths of the array, the array is instead
+ *		rehashed first: doubled if the elements alone would fill
+ *		half of it, otherwise kept the same size to clear out the
+ *		deleted slots.
+ */
+
+static void place(SET *sp, void *elt, unsigned h, int locn)
+{
+    if (sp->count + sp->deleted + 1 > sp->length / 8 * 7) {
+	if (sp->count + 1 > sp->length / 2)
+	    rehash(sp, sp->groups * 2);
+	else
+	    rehash(sp, sp->groups);
+
+	insert(sp, elt, h);
+
+    } else
+	fill(sp, locn, elt, h);
+
+    sp->count ++;
+}
+
+
+/*
+ * Function:    add
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Add ELT, whose hash value is H, to the set pointed to by SP
+ *		unless an equal element is present, and return whichever
+ *		element is in the set afterwards.
+ */
+
+static void *add(SET *sp, void *elt, unsigned h)
+{
+    int locn;
+    bool found;
+
+
+    locn = search(sp, elt, h, &found);
+
+    if (found)
+	return sp->data[locn];
+
+    place(sp, elt, h, locn);
+    return elt;
+}
+
+
+/*
+ * Function:    erase
+ *
+ * Complexity:  O(1) average case, O(m) worst case
+ *
+ * Description: Remove the element in slot LOCN of the set pointed to by SP
+ *		and return it.  If the group holding it still has an empty
+ *		slot then no search ever probed past the group, so the slot
+ *		can be marked empty; otherwise it must be marked deleted.
+ *		The array is shrunk once it is less than an eighth full.
+ */
+
+static void *erase(SET *sp, int locn)
+{
+    void *elt;
+
+
+    elt = sp->data[locn];
+
+    if (matchByte(sp->ctrl + locn / GROUP_SIZE * GROUP_SIZE, EMPTY) != 0)
+	sp->ctrl[locn] = EMPTY;
+    else {
+	sp->ctrl[locn] = DELETED;
+	sp->deleted ++;
+    }
+
+    sp->count --;
+
+    if (sp->count < sp->length / 8 && sp->groups / 2 >= sp->minGroups)
+	rehash(sp, sp->groups / 2);
+
+    return elt;
+}
+
+
+/*
+ * Function:    prefetch
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Ask the processor to start loading the home group for the
+ *		hash value H in the set pointed to by SP.
+ */
+
+static void prefetch(SET *sp, unsigned h)
+{
+    int g;
+
+
+    g = (h >> 7) % sp->groups;
+
+    __builtin_prefetch(&sp->ctrl[g * GROUP_SIZE]);
+    __builtin_prefetch(&sp->data[g * GROUP_SIZE]);
+}
+
+
+/*
+ * Function:    addElement
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Add ELT to the set pointed to by SP.
+ */
+
+void addElement(SET *sp, void *elt)
+{
+    assert(sp != NULL && elt != NULL);
+    add(sp, elt, HASH(sp, elt));
+}
+
+
+/*
+ * Function:    removeElement
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Remove ELT from the set pointed to by SP.
+ */
+
+void removeElement(SET *sp, void *elt)
+{
+    int locn;
+    bool found;
+
+
+    assert(sp != NULL && elt != NULL);
+    locn = search(sp, elt, HASH(sp, elt), &found);
+
+    if (found)
+	erase(sp, locn);
+}
+
+
+/*
+ * Function:    findOrAddElement
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Return the element equal to ELT in the set pointed to by
+ *		SP, adding ELT if there is none, and set *INSERTED, if it
+ *		is not NULL, to whether ELT was added.
+ */
+
+void *findOrAddElement(SET *sp, void *elt, bool *inserted)
+{
+    int count;
+    void *found;
+
+
+    assert(sp != NULL && elt != NULL);
+
+    count = sp->count;
+    found = add(sp, elt, HASH(sp, elt));
+
+    if (inserted != NULL)
+	*inserted = sp->count != count;
+
+    return found;
+}
+
+
+/*
+ * Function:    toggleElement
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Remove the element equal to ELT from the set pointed to by
+ *		SP and return it, or add ELT in the free slot the search for
+ *		it returned and return NULL if there is none, so ELT is only
+ *		searched for once.
+ */
+
+void *toggleElement(SET *sp, void *elt)
+{
+    int locn;
+    bool found;
+    unsigned h;
+
+
+    assert(sp != NULL && elt != NULL);
+
+    h = HASH(sp, elt);
+    locn = search(sp, elt, h, &found);
+
+    if (found)
+	return erase(sp, locn);
+
+    place(sp, elt, h, locn);
+    return NULL;
+}
+
+
+/*
+ * Function:    findElement
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: If ELT is present in the set pointed to by SP then return
+ *		it, otherwise return NULL.
+ */
+
+void *findElement(SET *sp, void *elt)
+{
+    int locn;
+    bool found;
+
+
+    assert(sp != NULL && elt != NULL);
+
+    locn = search(sp, elt, HASH(sp, elt), &found);
+    return found ? sp->data[locn] : NULL;
+}
+
+
+/*
+ * Function:    findElements
+ *
+ * Complexity:  O(n) average case
+ *
+ * Description: Search the set pointed to by SP for each of the N elements
+ *		in ELTS, storing the element found or NULL in the same
+ *		position of FOUND.  The elements are hashed and their home
+ *		groups prefetched BATCH_SIZE at a time before any is
+ *		searched, so that their cache misses overlap.
+ */
+
+void findElements(SET *sp, void **elts, int n, void **found)
+{
+    int i, j, m, locn;
+    unsigned h[BATCH_SIZE];
+    bool present;
+
+
+    assert(sp != NULL && elts != NULL && found != NULL);
+
+    for (i = 0; i < n; i += BATCH_SIZE) {
+	m = n - i < BATCH_SIZE ? n - i : BATCH_SIZE;
+
+	for (j = 0; j < m; j ++) {
+	    h[j] = HASH(sp, elts[i + j]);
+	    prefetch(sp, h[j]);
+	}
+
+	for (j = 0; j < m; j ++) {
+	    locn = search(sp, elts[i + j], h[j], &present);
+	    found[i + j] = present ? sp->data[locn] : NULL;
+	}
+    }
+}
+
+
+/*
+ * Function:    addElements
+ *
+ * Complexity:  O(n) average case
+ *
+ * Description: Add each of the N elements in ELTS to the set pointed to by
+ *		SP, hashing and prefetching them in batches as in
+ *		findElements.  If FOUND is not NULL, the element in the set
+ *		afterwards is stored in the same position of FOUND; it
+ *		differs from the element given when an equal element was
+ *		already present, including one earlier in ELTS.
+ */
+
+void addElements(SET *sp, void **elts, int n, void **found)
+{
+    int i, j, m;
+    unsigned h[BATCH_SIZE];
+    void *elt;
+
+
+    assert(sp != NULL && elts != NULL);
+
+    for (i = 0; i < n; i += BATCH_SIZE) {
+	m = n - i < BATCH_SIZE ? n - i : BATCH_SIZE;
+
+	for (j = 0; j < m; j ++) {
+	    assert(elts[i + j] != NULL);
+	    h[j] = HASH(sp, elts[i + j]);
+	    prefetch(sp, h[j]);
+	}
+
+	for (j = 0; j < m; j ++) {
+	    elt = add(sp, elts[i + j], h[j]);
+
+	    if (found != NULL)
+		found[i + j] = elt;
+	}
+    }
+}
+
+
+/*
+ * Function:    compactSet
+ *
+ * Complexity:  O(m)
+ *
+ * Description: Remove any deleted slots from the set pointed to by SP by
+ *		rehashing it into a new array of the same size.
+ */
+
+void compactSet(SET *sp)
+{
+    assert(sp != NULL);
+
+    if (sp->deleted > 0)
+	rehash(sp, sp->groups);
+}
+
+
+/*
+ * Function:	getElements
+ *
+ * Complexity:	O(m)
+ *
+ * Description:	Allocate and return an array of elements in the set pointed
+ *		to by SP, in sorted order.
+ */
+
+void *getElements(SET *sp)
+{
+    int i, j;
+    void **elts;
+
+
+    assert(sp != NULL);
+
+    elts = malloc(sizeof(void *) * sp->count);
+    assert(elts != NULL);
+
+    for (i = 0, j = 0; i < sp->length; i ++)
+	if (sp->ctrl[i] >= 0)
+	    elts[j ++] = sp->data[i];
+
+    quickSort(elts, 0, sp->count-1, sp->compare);
+
+    return elts;
+}
+
+/*
+ * Function:    beginSet
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Start the iterator of the set pointed to by SP over at
+ *		the first slot and return it.
+ */
+
+SETITER *beginSet(SET *sp)
+{
+    assert(sp != NULL);
+
+    sp->iter.locn = 0;
+    return &sp->iter;
+}
+
+
+/*
+ * Function:    nextElement
+ *
+ * Complexity:  O(1) average case
+ *
+ * Description: Return the next element of the walk by the iterator
+ *		pointed to by IT, or NULL once every element has been
+ *		returned.
+ */
+
+void *nextElement(SETITER *it)
+{
+    SET *sp;
+
+
+    assert(it != NULL);
+    sp = it->sp;
+
+    while (it->locn < sp->length)
+	if (sp->ctrl[it->locn ++] >= 0)
+	    return sp->data[it->locn - 1];
+
+    return NULL;
+}
+
+
+/*
+ * Function:    forEachElement
+ *
+ * Complexity:  O(m)
+ *
+ * Description: Call FN with each element in the set pointed to by SP and
+ *		CTX, in the order they are stored.
+ */
+
+void forEachElement(SET *sp, void (*fn)(), void *ctx)
+{
+    int i;
+
+
+    assert(sp != NULL && fn != NULL);
+
+    for (i = 0; i < sp->length; i ++)
+	if (sp->ctrl[i] >= 0)
+	    (*fn)(sp->data[i], ctx);
+}
+
+
+
+/*
+ * Function:    getSetStats
+ *
+ * Complexity:  O(m)
+ *
+ * Description: Fill in the statistics pointed to by STATS for the set
+ *		pointed to by SP.  Searches probe whole groups, so the
+ *		histogram of probes counts groups rather than slots.  A run
+ *		is a stretch of slots that are not empty.
+ */
+
+void getSetStats(SET *sp, struct setstats *stats)
+{
+    int i, run;
+
+
+    assert(sp != NULL && stats != NULL);
+
+    memset(stats, 0, sizeof(struct setstats));
+    stats->count = sp->count;
+    stats->length = sp->length;
+    stats->tombstones = sp->deleted;
+    stats->bytes = sizeof(SET) + (sizeof(void *) + 1) * sp->length;
+
+    for (i = 0, run = 0; i < sp->length; i ++) {
+	if (sp->ctrl[i] != EMPTY)
+	    run ++;
+	else if (run > 0) {
+	    stats->chains[statBucket(run)] ++;
+	    run = 0;
+	}
+    }
+
+    if (run > 0)
+	stats->chains[statBucket(run)] ++;
+
+# ifdef SETSTATS
+    stats->compares = sp->stats.compares;
+    stats->hashes = sp->stats.hashes;
+    memcpy(stats->probes, sp->stats.probes, sizeof(stats->probes));
+# else
+    stats->compares = -1;
+    stats->hashes = -1;
+# endif
+}
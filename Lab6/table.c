@@ -11,7 +11,26 @@
  *              This implementation uses a hash table to store the
  *              elements, with linear probing to resolve collisions.
  *              Insertion, deletion, and membership checks are all average
- *              case constant time.
+ *              case constant time.  The full hash value of each element is
+ *              kept beside it, so the comparison function is only called
+ *              when the hash values match, and elements never need to be
+ *              hashed again once they are in the table.
+ *
+ *              The table grows when it becomes half full and shrinks when
+ *              it falls below an eighth full.  Rather than rehashing every
+ *              element at once, a resize is spread over many operations.
+ *              The new array is mapped directly from the kernel, and each
+ *              insertion or deletion first touches a few of its pages, so
+ *              no later operation stalls on a page fault.  Once every page
+ *              is in, each operation moves a bounded number of slots from
+ *              the old array, and until the old array is empty, searches
+ *              examine both arrays.  The emptied old array is then handed
+ *              back to the kernel a few pages per operation, rather than
+ *              all at once.
+ *
+ *              Deleted slots are counted, and once they take up a quarter
+ *              of the array the elements are rehashed in place, which
+ *              clears every deleted slot without allocating a new array.
  */
 
 # include <stdio.h>
@@ -19,132 +38,416 @@
 # include <string.h>
 # include <assert.h>
 # include <stdbool.h>
+# include <limits.h>
+# include <unistd.h>
+# include <sys/mman.h>
 # include "set.h"
+# include "stats.h"
+# include "sort.h"
 
 # define EMPTY   0
 # define FILLED  1
 # define DELETED 2
+# define MOVING  3
+
+# define MIN_LENGTH	16	/* smallest array ever allocated      */
+# ifndef MIGRATE_STEPS
+# define MIGRATE_STEPS	8	/* old slots moved per operation      */
+# endif
+# ifndef PREFAULT_PAGES
+# define PREFAULT_PAGES	4	/* new pages touched per operation    */
+# endif
+# ifndef RELEASE_PAGES
+# define RELEASE_PAGES	16	/* old pages unmapped per operation   */
+# endif
+# define BATCH_SIZE	16	/* elements prefetched at once        */
+
+# ifdef SETSTATS
+# define COUNT(x)	((x) ++)
+# define RECORD(h, n)	((h)[statBucket(n)] ++)
+# else
+# define COUNT(x)	((void) 0)
+# define RECORD(h, n)	((void) 0)
+# endif
+
+# define HASH(sp, elt)	(COUNT((sp)->stats.hashes), (*(sp)->hash)(elt))
+# define COMPARE(sp, x, y) \
+    (COUNT((sp)->stats.compares), (*(sp)->compare)(x, y))
+
+struct table {
+    int length;                 /* length of allocated array          */
+    void **data;                /* array of allocated elements        */
+    unsigned *hashes;           /* hash value of each element         */
+    char *flags;                /* state of each slot in array        */
+    int deleted;                /* number of deleted slots            */
+    char *base;                 /* mapping holding the three arrays   */
+    size_t size;                /* bytes in the mapping               */
+    size_t touched;             /* bytes of the mapping faulted in    */
+};
+
+struct setiter {
+    SET *sp;                    /* set being walked                   */
+    struct table *tp;           /* array being walked                 */
+    int locn;                   /* next slot of that array            */
+};
 
 struct set {
-    int count;                  /* number of elements in array */
-    int length;                 /* length of allocated array   */
-    void **data;                /* array of allocated elements */
-    char *flags;                /* state of each slot in array */
-    int (*compare)();		/* comparison function         */
-    unsigned (*hash)();		/* hash function               */
+    int count;                  /* number of elements in both arrays  */
+    struct table cur;           /* array new elements are added to    */
+    struct table old;           /* array being migrated, if any       */
+    struct table next;          /* array being faulted in, if any     */
+    struct table dead;          /* array being unmapped, if any       */
+    int moved;                  /* old slots migrated so far          */
+    int minLength;              /* initial length, never shrunk below */
+    int (*compare)();		/* comparison function                */
+    unsigned (*hash)();		/* hash function                      */
+    struct setiter iter;        /* the set's one iterator             */
+# ifdef SETSTATS
+    struct setstats stats;      /* counters kept as the set is used   */
+# endif
 };
 
+static size_t pageSize;         /* size of a page of memory           */
+
+
 /*
- * Function: Swap
- *
- * Complexity: O(1)
+ * Function:    search
  *
- * Description: Swaps two values
+ * Complexity:  O(1) average case, O(n) worst case
  *
+ * Description: Return the location of ELT, whose hash value is H, in the
+ *		array pointed to by TP.  If the element is present, then
+ *		*FOUND is true.  If not present, then *FOUND is false.  The
+ *		element is first hashed to its correct location.  Linear
+ *		probing is used to examine subsequent locations, and an
+ *		element is only compared if its hash value is H.
  */
 
-void swap(void **a, void **b){
+static int search(SET *sp, struct table *tp, void *elt, unsigned h,
+	bool *found)
+{
+    int available, i, locn, start;
+
+
+    available = -1;
+    start = h % tp->length;
+
+    for (i = 0; i < tp->length; i ++) {
+        locn = (start + i) % tp->length;
+
+        if (tp->flags[locn] == EMPTY) {
+	    RECORD(sp->stats.probes, i + 1);
+            *found = false;
+            return available != -1 ? available : locn;
+
+        } else if (tp->flags[locn] == DELETED) {
+            if (available == -1)
+		available = locn;
+
+        } else if (tp->hashes[locn] == h &&
+		COMPARE(sp, tp->data[locn], elt) == 0) {
+	    RECORD(sp->stats.probes, i + 1);
+            *found = true;
+            return locn;
+        }
+    }
+
+    RECORD(sp->stats.probes, tp->length);
+    *found = false;
+    return available;
+}
 
-	void* temp;
-	temp = *a;
-	*a = *b;
-	*b = temp;
 
+/*
+ * Function:    clear
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Mark the table pointed to by TP as having no arrays.
+ */
+
+static void clear(struct table *tp)
+{
+    tp->length = 0;
+    tp->data = NULL;
+    tp->hashes = NULL;
+    tp->flags = NULL;
+    tp->deleted = 0;
+    tp->base = NULL;
+    tp->size = 0;
+    tp->touched = 0;
 }
 
+
 /*
- * Function: Partition
- * 
- * Complexity: O(n)
+ * Function:    allocate
  *
- * Decription: Partition function to be used in recursive 
- * quickSort function
+ * Complexity:  O(1) (the pages are zeroed by the kernel as they are touched)
  *
+ * Description: Allocate the arrays for a table of LENGTH empty slots.  The
+ *		three arrays share one mapping so that its pages can be
+ *		faulted in and handed back a few at a time.
  */
 
-int partition(void **data, int lo, int hi, int(*compare)()){
+static void allocate(struct table *tp, int length)
+{
+    size_t bytes;
 
-	int i, sep;
-	void *x = data[hi];
-	sep = lo;
-	for(i = lo; i<hi; i++){
-		
-		if((*compare)(data[i], x) <= 0){
 
-			swap(data[i], data[sep]);
-			sep++;
+    bytes = (sizeof(void *) + sizeof(unsigned) + 1) * (size_t) length;
 
-		}
-	}
+    tp->size = (bytes + pageSize - 1) / pageSize * pageSize;
+    tp->base = mmap(NULL, tp->size, PROT_READ | PROT_WRITE,
+	MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    assert(tp->base != MAP_FAILED);
+
+    tp->length = length;
+    tp->data = (void **) tp->base;
+    tp->hashes = (unsigned *) (tp->data + length);
+    tp->flags = (char *) (tp->hashes + length);
+    tp->deleted = 0;
+    tp->touched = 0;
+}
+
+
+/*
+ * Function:    prefault
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Write to up to PAGES pages of the table pointed to by TP
+ *		that have not been touched yet, so that they are faulted in
+ *		now rather than by some later operation.  Return true once
+ *		every page has been touched.
+ */
 
-	swap(data[sep], data[hi]);
-	return sep;
+static bool prefault(struct table *tp, int pages)
+{
+    while (pages -- > 0 && tp->touched < tp->size) {
+	tp->base[tp->touched] = 0;
+	tp->touched += pageSize;
+    }
 
+    return tp->touched >= tp->size;
 }
 
+
 /*
- * Function: Quick Sort
+ * Function:    release
  *
- * Complexity: O(n logn)
+ * Complexity:  O(n)
  *
- * Description: Recursive function that uses partition
- * function to sort void** set by splitting it into smaller
- * sections based on a seperator and sorting based on seperator
+ * Description: Deallocate the arrays of the table pointed to by TP.
+ */
+
+static void release(struct table *tp)
+{
+    if (tp->base != NULL)
+	munmap(tp->base, tp->size);
+
+    clear(tp);
+}
+
+
+/*
+ * Function:    shed
  *
+ * Complexity:  O(1)
+ *
+ * Description: Unmap up to PAGES pages from the front of the table pointed
+ *		to by TP, whose slots are no longer used.
  */
 
-void quickSort(void **data, int lo, int hi, int(*compare)()){
+static void shed(struct table *tp, int pages)
+{
+    size_t bytes;
 
-	if(lo < hi){
 
-		int ploc = partition(data, lo, hi, compare);
-		quickSort(data, lo, ploc-1, compare);
-		quickSort(data, ploc+1, hi, compare);
+    bytes = (size_t) pages * pageSize;
 
-	}
+    if (bytes >= tp->size)
+	release(tp);
 
+    else {
+	munmap(tp->base, bytes);
+	tp->base += bytes;
+	tp->size -= bytes;
+    }
 }
 
 
 /*
- * Function:    search
+ * Function:    migrate
  *
  * Complexity:  O(1) average case, O(n) worst case
  *
- * Description: Return the location of ELT in the set pointed to by SP.  If
- *		the element is present, then *FOUND is true.  If not
- *		present, then *FOUND is false.  The element is first hashed
- *		to its correct location.  Linear probing is used to examine
- *		subsequent locations.
+ * Description: Move up to STEPS slots from the old array into the current
+ *		array of the set pointed to by SP, using the stored hash
+ *		values.  A moved slot is marked as deleted in the old array
+ *		so that searches of the old array still probe past it.  Once
+ *		every slot has been moved, the old array is set aside to be
+ *		unmapped by later operations.  Any array still set aside
+ *		from an earlier resize is unmapped at once.
  */
 
-static int search(SET *sp, void *elt, bool *found)
+static void migrate(SET *sp, int steps)
 {
-    int available, i, locn, start;
+    int locn;
+    unsigned h;
 
 
-    available = -1;
-    start = (*sp->hash)(elt) % sp->length;
+    while (sp->old.data != NULL && steps -- > 0) {
+	if (sp->old.flags[sp->moved] == FILLED) {
+	    h = sp->old.hashes[sp->moved];
+	    locn = h % sp->cur.length;
 
-    for (i = 0; i < sp->length; i ++) {
-        locn = (start + i) % sp->length;
+	    while (sp->cur.flags[locn] == FILLED)
+		locn = (locn + 1) % sp->cur.length;
 
-        if (sp->flags[locn] == EMPTY) {
-            *found = false;
-            return available != -1 ? available : locn;
+	    if (sp->cur.flags[locn] == DELETED)
+		sp->cur.deleted --;
 
-        } else if (sp->flags[locn] == DELETED) {
-            if (available == -1)
-		available = locn;
+	    sp->cur.data[locn] = sp->old.data[sp->moved];
+	    sp->cur.hashes[locn] = h;
+	    sp->cur.flags[locn] = FILLED;
+	    sp->old.flags[sp->moved] = DELETED;
+	}
 
-        } else if ((*sp->compare)(sp->data[locn], elt) == 0) {
-            *found = true;
-            return locn;
-        }
+	if (++ sp->moved == sp->old.length) {
+	    release(&sp->dead);
+	    sp->dead = sp->old;
+	    clear(&sp->old);
+	}
     }
+}
 
-    *found = false;
-    return available;
+
+/*
+ * Function:    resize
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Begin moving the elements of the set pointed to by SP into
+ *		its next array, whose pages have all been faulted in.  No
+ *		elements are moved here; instead, each later operation moves
+ *		a few slots so that no single operation pays for rehashing
+ *		the entire table.
+ */
+
+static void resize(SET *sp)
+{
+    assert(sp->old.data == NULL);
+
+    sp->old = sp->cur;
+    sp->moved = 0;
+    sp->cur = sp->next;
+    clear(&sp->next);
+}
+
+
+/*
+ * Function:    compact
+ *
+ * Complexity:  O(m) average case
+ *
+ * Description: Rehash the elements of the table pointed to by TP in place
+ *		so that it has no deleted slots.  Deleted slots are first
+ *		marked empty and full slots marked as moving.  Each moving
+ *		element is then reinserted along its probe sequence: if it
+ *		lands on another moving slot the two are exchanged and the
+ *		displaced element is reinserted in turn, so every element
+ *		ends up in place without a second array.
+ */
+
+static void compact(struct table *tp)
+{
+    int i, locn;
+    void *elt, *temp;
+    unsigned h, htemp;
+
+
+    for (i = 0; i < tp->length; i ++)
+	if (tp->flags[i] == DELETED)
+	    tp->flags[i] = EMPTY;
+	else if (tp->flags[i] == FILLED)
+	    tp->flags[i] = MOVING;
+
+    for (i = 0; i < tp->length; i ++) {
+	if (tp->flags[i] != MOVING)
+	    continue;
+
+	elt = tp->data[i];
+	h = tp->hashes[i];
+	tp->flags[i] = EMPTY;
+
+	while (1) {
+	    locn = h % tp->length;
+
+	    while (tp->flags[locn] == FILLED)
+		locn = (locn + 1) % tp->length;
+
+	    if (tp->flags[locn] == EMPTY) {
+		tp->data[locn] = elt;
+		tp->hashes[locn] = h;
+		tp->flags[locn] = FILLED;
+		break;
+	    }
+
+	    temp = tp->data[locn];
+	    htemp = tp->hashes[locn];
+	    tp->data[locn] = elt;
+	    tp->hashes[locn] = h;
+	    tp->flags[locn] = FILLED;
+	    elt = temp;
+	    h = htemp;
+	}
+    }
+
+    tp->deleted = 0;
+}
+
+
+/*
+ * Function:    rebalance
+ *
+ * Complexity:  O(1) average case
+ *
+ * Description: Continue any resize in progress for the set pointed to by
+ *		SP, or start one if the current array is more than half full
+ *		or less than an eighth full.  A resize first faults in the
+ *		pages of the next array and then migrates the old array into
+ *		it.  Should the current array come close to filling before
+ *		a resize has finished, the rest of it is done immediately.
+ *		Otherwise, if a quarter of the array is deleted slots, it is
+ *		compacted.  Each call also unmaps part of any array left
+ *		over from a finished resize.
+ */
+
+static void rebalance(SET *sp)
+{
+    if (sp->dead.base != NULL)
+	shed(&sp->dead, RELEASE_PAGES);
+
+    if (sp->next.base != NULL) {
+	if (prefault(&sp->next, sp->count >= sp->cur.length / 4 * 3 ?
+		INT_MAX : PREFAULT_PAGES))
+	    resize(sp);
+
+    } else if (sp->old.data != NULL) {
+	if (sp->count >= sp->cur.length / 4 * 3)
+	    migrate(sp, sp->old.length - sp->moved);
+	else
+	    migrate(sp, MIGRATE_STEPS);
+
+    } else if (sp->count >= sp->cur.length / 2)
+	allocate(&sp->next, sp->cur.length * 2);
+
+    else if (sp->count < sp->cur.length / 8 &&
+	    sp->cur.length / 2 >= sp->minLength)
+	allocate(&sp->next, sp->cur.length / 2);
+
+    else if (sp->cur.deleted > sp->cur.length / 4)
+	compact(&sp->cur);
 }
 
 
@@ -153,34 +456,44 @@ static int search(SET *sp, void *elt, bool *found)
  *
  * Complexity:  O(m)
  *
- * Description: Return a pointer to a new set with a maximum capacity of
- *		MAXELTS.
+ * Description: Return a pointer to a new set with an initial capacity of
+ *		MAXELTS.  The set grows and shrinks as elements are added
+ *		and removed, but never shrinks below MAXELTS.
  */
 
 SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)())
 {
-    int i;
     SET *sp;
 
 
     assert(compare != NULL && hash != NULL);
 
+    if (maxElts < MIN_LENGTH)
+	maxElts = MIN_LENGTH;
+
     sp = malloc(sizeof(SET));
     assert(sp != NULL);
 
-    sp->data = malloc(sizeof(char *) * maxElts);
-    assert(sp->data != NULL);
+    if (pageSize == 0)
+	pageSize = sysconf(_SC_PAGESIZE);
+
+    allocate(&sp->cur, maxElts);
+    prefault(&sp->cur, INT_MAX);
 
-    sp->flags = malloc(sizeof(char) * maxElts);
-    assert(sp->flags != NULL);
+    clear(&sp->old);
+    clear(&sp->next);
+    clear(&sp->dead);
+    sp->moved = 0;
 
     sp->compare = compare;
     sp->hash = hash;
-    sp->length = maxElts;
+    sp->iter.sp = sp;
+    sp->minLength = maxElts;
     sp->count = 0;
 
-    for (i = 0; i < maxElts; i ++)
-        sp->flags[i] = EMPTY;
+# ifdef SETSTATS
+    memset(&sp->stats, 0, sizeof(struct setstats));
+# endif
 
     return sp;
 }
@@ -189,7 +502,7 @@ SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)())
 /*
  * Function:    destroySet
  *
- * Complexity:  O(m)
+ * Complexity:  O(1)
  *
  * Description: Deallocate memory associated with the set pointed to by SP.
  *		The elements themselves are not deallocated since we did not
@@ -201,8 +514,10 @@ void destroySet(SET *sp)
 {
     assert(sp != NULL);
 
-    free(sp->flags);
-    free(sp->data);
+    release(&sp->dead);
+    release(&sp->next);
+    release(&sp->old);
+    release(&sp->cur);
     free(sp);
 }
 
@@ -223,29 +538,173 @@ int numElements(SET *sp)
 
 
 /*
- * Function:    addElement
+ * Function:    place
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Put ELT, whose hash value is H, in slot LOCN of the current
+ *		array of the set pointed to by SP, which a search of that
+ *		array returned for it.
+ */
+
+static void place(SET *sp, int locn, void *elt, unsigned h)
+{
+    assert(locn != -1);
+
+    if (sp->cur.flags[locn] == DELETED)
+	sp->cur.deleted --;
+
+    sp->cur.data[locn] = elt;
+    sp->cur.hashes[locn] = h;
+    sp->cur.flags[locn] = FILLED;
+    sp->count ++;
+}
+
+
+/*
+ * Function:    insert
  *
  * Complexity:  O(1) average case, O(n) worst case
  *
- * Description: Add ELT to the set pointed to by SP.
+ * Description: Add ELT, whose hash value is H, to the set pointed to by SP
+ *		unless an equal element is present, and return whichever
+ *		element is in the set afterwards.  During a migration the
+ *		element may still be in the old array, so both arrays are
+ *		searched before adding it to the current one.
  */
 
-void addElement(SET *sp, void *elt)
+static void *insert(SET *sp, void *elt, unsigned h)
+{
+    int locn, oldLocn;
+    bool found;
+
+
+    rebalance(sp);
+    locn = search(sp, &sp->cur, elt, h, &found);
+
+    if (found)
+	return sp->cur.data[locn];
+
+    if (sp->old.data != NULL) {
+	oldLocn = search(sp, &sp->old, elt, h, &found);
+
+	if (found)
+	    return sp->old.data[oldLocn];
+    }
+
+    place(sp, locn, elt, h);
+    return elt;
+}
+
+
+/*
+ * Function:    erase
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Remove the element equal to ELT, whose hash value is H,
+ *		from the set pointed to by SP and return it, or return NULL
+ *		if there is none.  A element is deleted by changing the
+ *		state of its slot in whichever array holds it.  *LOCN is
+ *		set to the slot of the current array that the search
+ *		returned, where ELT would be added.
+ */
+
+static void *erase(SET *sp, void *elt, unsigned h, int *locn)
+{
+    int oldLocn;
+    bool found;
+
+
+    *locn = search(sp, &sp->cur, elt, h, &found);
+
+    if (found) {
+	sp->cur.flags[*locn] = DELETED;
+	sp->cur.deleted ++;
+	sp->count --;
+	return sp->cur.data[*locn];
+    }
+
+    if (sp->old.data != NULL) {
+	oldLocn = search(sp, &sp->old, elt, h, &found);
+
+	if (found) {
+	    sp->old.flags[oldLocn] = DELETED;
+	    sp->count --;
+	    return sp->old.data[oldLocn];
+	}
+    }
+
+    return NULL;
+}
+
+
+/*
+ * Function:    lookup
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Return the element equal to ELT, whose hash value is H, in
+ *		the set pointed to by SP, or NULL if there is none.
+ */
+
+static void *lookup(SET *sp, void *elt, unsigned h)
 {
     int locn;
     bool found;
 
 
-    assert(sp != NULL && elt != NULL);
-    locn = search(sp, elt, &found);
+    locn = search(sp, &sp->cur, elt, h, &found);
+
+    if (found)
+	return sp->cur.data[locn];
 
-    if (!found) {
-	assert(sp->count < sp->length);
+    if (sp->old.data != NULL) {
+	locn = search(sp, &sp->old, elt, h, &found);
 
-	sp->data[locn] = elt;
-	sp->flags[locn] = FILLED;
-	sp->count ++;
+	if (found)
+	    return sp->old.data[locn];
     }
+
+    return NULL;
+}
+
+
+/*
+ * Function:    prefetch
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Ask the processor to start loading the home slot for the
+ *		hash value H in the current array of the set pointed to by
+ *		SP, so that the load overlaps with work on other elements.
+ */
+
+static void prefetch(SET *sp, unsigned h)
+{
+    int locn;
+
+
+    locn = h % sp->cur.length;
+
+    __builtin_prefetch(&sp->cur.flags[locn]);
+    __builtin_prefetch(&sp->cur.hashes[locn]);
+    __builtin_prefetch(&sp->cur.data[locn]);
+}
+
+
+/*
+ * Function:    addElement
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Add ELT to the set pointed to by SP.
+ */
+
+void addElement(SET *sp, void *elt)
+{
+    assert(sp != NULL && elt != NULL);
+    insert(sp, elt, HASH(sp, elt));
 }
 
 
@@ -254,23 +713,78 @@ void addElement(SET *sp, void *elt)
  *
  * Complexity:  O(1) average case, O(n) worst case
  *
- * Description: Remove ELT from the set pointed to by SP.  A element is
- *		deleted by changing the state of its slot.
+ * Description: Remove ELT from the set pointed to by SP.
  */
 
 void removeElement(SET *sp, void *elt)
 {
     int locn;
-    bool found;
 
 
     assert(sp != NULL && elt != NULL);
-    locn = search(sp, elt, &found);
 
-    if (found) {
-	sp->flags[locn] = DELETED;
-	sp->count --;
-    }
+    if (erase(sp, elt, HASH(sp, elt), &locn) != NULL)
+	rebalance(sp);
+}
+
+
+/*
+ * Function:    findOrAddElement
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Return the element equal to ELT in the set pointed to by
+ *		SP, adding ELT if there is none, and set *INSERTED, if it
+ *		is not NULL, to whether ELT was added.
+ */
+
+void *findOrAddElement(SET *sp, void *elt, bool *inserted)
+{
+    int count;
+    void *found;
+
+
+    assert(sp != NULL && elt != NULL);
+
+    count = sp->count;
+    found = insert(sp, elt, HASH(sp, elt));
+
+    if (inserted != NULL)
+	*inserted = sp->count != count;
+
+    return found;
+}
+
+
+/*
+ * Function:    toggleElement
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Remove the element equal to ELT from the set pointed to by
+ *		SP and return it, or add ELT and return NULL if there is
+ *		none.  ELT is added in the slot that the search for it
+ *		returned, so it is only searched for once, and the set is
+ *		rebalanced afterwards either way.
+ */
+
+void *toggleElement(SET *sp, void *elt)
+{
+    int locn;
+    unsigned h;
+    void *removed;
+
+
+    assert(sp != NULL && elt != NULL);
+
+    h = HASH(sp, elt);
+    removed = erase(sp, elt, h, &locn);
+
+    if (removed == NULL)
+	place(sp, locn, elt, h);
+
+    rebalance(sp);
+    return removed;
 }
 
 
@@ -285,14 +799,106 @@ void removeElement(SET *sp, void *elt)
 
 void *findElement(SET *sp, void *elt)
 {
-    int locn;
-    bool found;
+    assert(sp != NULL && elt != NULL);
+    return lookup(sp, elt, HASH(sp, elt));
+}
 
 
-    assert(sp != NULL && elt != NULL);
+/*
+ * Function:    findElements
+ *
+ * Complexity:  O(n) average case
+ *
+ * Description: Search the set pointed to by SP for each of the N elements
+ *		in ELTS, storing the element found or NULL in the same
+ *		position of FOUND.  The elements are handled BATCH_SIZE at a
+ *		time: all of them are hashed and their home slots prefetched
+ *		before any is searched, so that the cache misses for
+ *		different elements overlap rather than follow one another.
+ */
+
+void findElements(SET *sp, void **elts, int n, void **found)
+{
+    int i, j, m;
+    unsigned h[BATCH_SIZE];
+
+
+    assert(sp != NULL && elts != NULL && found != NULL);
+
+    for (i = 0; i < n; i += BATCH_SIZE) {
+	m = n - i < BATCH_SIZE ? n - i : BATCH_SIZE;
+
+	for (j = 0; j < m; j ++) {
+	    h[j] = HASH(sp, elts[i + j]);
+	    prefetch(sp, h[j]);
+	}
+
+	for (j = 0; j < m; j ++)
+	    found[i + j] = lookup(sp, elts[i + j], h[j]);
+    }
+}
+
+
+/*
+ * Function:    addElements
+ *
+ * Complexity:  O(n) average case
+ *
+ * Description: Add each of the N elements in ELTS to the set pointed to by
+ *		SP, hashing and prefetching them in batches as in
+ *		findElements.  If FOUND is not NULL, the element in the set
+ *		afterwards is stored in the same position of FOUND; it
+ *		differs from the element given when an equal element was
+ *		already present, including one earlier in ELTS.
+ */
+
+void addElements(SET *sp, void **elts, int n, void **found)
+{
+    int i, j, m;
+    unsigned h[BATCH_SIZE];
+    void *elt;
+
+
+    assert(sp != NULL && elts != NULL);
+
+    for (i = 0; i < n; i += BATCH_SIZE) {
+	m = n - i < BATCH_SIZE ? n - i : BATCH_SIZE;
+
+	for (j = 0; j < m; j ++) {
+	    assert(elts[i + j] != NULL);
+	    h[j] = HASH(sp, elts[i + j]);
+	    prefetch(sp, h[j]);
+	}
+
+	for (j = 0; j < m; j ++) {
+	    elt = insert(sp, elts[i + j], h[j]);
 
-    locn = search(sp, elt, &found);
-    return found ? sp->data[locn] : NULL;
+	    if (found != NULL)
+		found[i + j] = elt;
+	}
+    }
+}
+
+
+/*
+ * Function:    compactSet
+ *
+ * Complexity:  O(m) average case
+ *
+ * Description: Finish any migration in progress for the set pointed to by
+ *		SP and then rehash its elements in place, removing every
+ *		deleted slot.  Callers can use this between phases of a
+ *		workload that deletes heavily.
+ */
+
+void compactSet(SET *sp)
+{
+    assert(sp != NULL);
+
+    migrate(sp, sp->old.length - sp->moved);
+
+    if (sp->cur.deleted > 0)
+	compact(&sp->cur);
 }
 
 
@@ -316,11 +922,168 @@ void *getElements(SET *sp)
     elts = malloc(sizeof(void *) * sp->count);
     assert(elts != NULL);
 
-    for (i = 0, j = 0; i < sp->length; i ++)
-	if (sp->flags[i] == FILLED)
-	    elts[j ++] = sp->data[i];
+    for (i = 0, j = 0; i < sp->cur.length; i ++)
+	if (sp->cur.flags[i] == FILLED)
+	    elts[j ++] = sp->cur.data[i];
+
+    for (i = sp->moved; i < sp->old.length; i ++)
+	if (sp->old.flags[i] == FILLED)
+	    elts[j ++] = sp->old.data[i];
 
     quickSort(elts, 0, sp->count-1, sp->compare);
-	
+
     return elts;
 }
+
+/*
+ * Function:    beginSet
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Start the iterator of the set pointed to by SP over at
+ *		the first slot of the current array and return it.
+ */
+
+SETITER *beginSet(SET *sp)
+{
+    assert(sp != NULL);
+
+    sp->iter.tp = &sp->cur;
+    sp->iter.locn = 0;
+    return &sp->iter;
+}
+
+
+/*
+ * Function:    nextElement
+ *
+ * Complexity:  O(1) average case
+ *
+ * Description: Return the next element of the walk by the iterator
+ *		pointed to by IT, or NULL once every element has been
+ *		returned.  The current array is walked first, then any
+ *		part of the old array that has not yet been migrated.
+ */
+
+void *nextElement(SETITER *it)
+{
+    struct table *tp;
+
+
+    assert(it != NULL);
+
+    while (1) {
+	tp = it->tp;
+
+	while (it->locn < tp->length)
+	    if (tp->flags[it->locn ++] == FILLED)
+		return tp->data[it->locn - 1];
+
+	if (tp != &it->sp->cur || it->sp->old.data == NULL)
+	    return NULL;
+
+	it->tp = &it->sp->old;
+	it->locn = it->sp->moved;
+    }
+}
+
+
+/*
+ * Function:    forEachElement
+ *
+ * Complexity:  O(m)
+ *
+ * Description: Call FN with each element in the set pointed to by SP and
+ *		CTX, in the order they are stored.
+ */
+
+void forEachElement(SET *sp, void (*fn)(), void *ctx)
+{
+    int i;
+
+
+    assert(sp != NULL && fn != NULL);
+
+    for (i = 0; i < sp->cur.length; i ++)
+	if (sp->cur.flags[i] == FILLED)
+	    (*fn)(sp->cur.data[i], ctx);
+
+    for (i = sp->moved; i < sp->old.length; i ++)
+	if (sp->old.flags[i] == FILLED)
+	    (*fn)(sp->old.data[i], ctx);
+}
+
+
+
+/*
+ * Function:    tally
+ *
+ * Complexity:  O(n)
+ *
+ * Description: Add the slots of the table pointed to by TP to the
+ *		statistics pointed to by STATS.  A run is a stretch of
+ *		slots that are not empty, since a search that starts
+ *		anywhere in a run probes to its end on a miss.
+ */
+
+static void tally(struct table *tp, struct setstats *stats)
+{
+    int i, run;
+
+
+    stats->length += tp->length;
+    stats->bytes += (sizeof(void *) + sizeof(unsigned) + 1) * tp->length;
+
+    for (i = 0, run = 0; i < tp->length; i ++) {
+	if (tp->flags[i] == DELETED)
+	    stats->tombstones ++;
+
+	if (tp->flags[i] != EMPTY)
+	    run ++;
+	else if (run > 0) {
+	    stats->chains[statBucket(run)] ++;
+	    run = 0;
+	}
+    }
+
+    if (run > 0)
+	stats->chains[statBucket(run)] ++;
+}
+
+
+/*
+ * Function:    getSetStats
+ *
+ * Complexity:  O(m)
+ *
+ * Description: Fill in the statistics pointed to by STATS for the set
+ *		pointed to by SP.  While a resize is under way, both arrays
+ *		are included, and a search of each array counts as a search.
+ *		The bytes include any array still being faulted in or
+ *		unmapped.
+ */
+
+void getSetStats(SET *sp, struct setstats *stats)
+{
+    assert(sp != NULL && stats != NULL);
+
+    memset(stats, 0, sizeof(struct setstats));
+    stats->count = sp->count;
+    stats->bytes = sizeof(SET);
+
+    tally(&sp->cur, stats);
+
+    if (sp->old.data != NULL)
+	tally(&sp->old, stats);
+
+    stats->bytes += sp->next.size + sp->dead.size;
+
+# ifdef SETSTATS
+    stats->compares = sp->stats.compares;
+    stats->hashes = sp->stats.hashes;
+    memcpy(stats->probes, sp->stats.probes, sizeof(stats->probes));
+# else
+    stats->compares = -1;
+    stats->hashes = -1;
+# endif
+}
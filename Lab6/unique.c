@@ -12,6 +12,10 @@
  *              total words in the set are printed.  If the second file is
  *              given then all words in the second file are deleted from
  *              the set and the count printed.
+ *
+ *              Words are read in blocks, and each block is looked up and
+ *              inserted with a single call so that the set can overlap the
+ *              memory accesses for different words.
  */
 
 # include <stdio.h>
@@ -19,12 +23,17 @@
 # include <string.h>
 # include <stdbool.h>
 # include "set.h"
+# include "stats.h"
 
 
-/* This is sufficient for the test cases in /scratch/coen12. */
+/* This is only an initial size; the set grows as needed. */
 
 # define MAX_SIZE 18000
 
+# define BLOCK_SIZE 64
+
+static char buffers[BLOCK_SIZE][BUFSIZ];
+
 
 /*
  * Function:    strhash
@@ -44,6 +53,29 @@ static unsigned strhash(char *s)
 }
 
 
+/*
+ * Function:    readBlock
+ *
+ * Description: Read up to BLOCK_SIZE words from FP into the buffers
+ *              pointed to by BLOCK and return the number read.
+ */
+
+static int readBlock(FILE *fp, char **block)
+{
+    int n;
+
+
+    for (n = 0; n < BLOCK_SIZE; n ++) {
+	block[n] = buffers[n];
+
+	if (fscanf(fp, "%s", block[n]) != 1)
+	    break;
+    }
+
+    return n;
+}
+
+
 /*
  * Function:    main
  *
@@ -53,16 +85,24 @@ static unsigned strhash(char *s)
 int main(int argc, char *argv[])
 {
     FILE *fp;
-    char buffer[BUFSIZ], **elts, *word;
+    char *block[BLOCK_SIZE], *copies[BLOCK_SIZE], **elts, *word;
+    void *found[BLOCK_SIZE];
     SET *unique;
-    int i, words;
-    bool lflag = false;
+    struct setstats stats;
+    int i, m, n, words;
+    bool lflag = false, sflag = false;
 
 
     /* Check usage and open the first file. */
 
-    if (argc > 1 && strcmp(argv[1], "-l") == 0) {
-	lflag = true;
+    while (argc > 1 && argv[1][0] == '-') {
+	if (strcmp(argv[1], "-l") == 0)
+	    lflag = true;
+	else if (strcmp(argv[1], "-s") == 0)
+	    sflag = true;
+	else
+	    break;
+
 	argc --;
 
 	for (i = 1; i < argc; i ++)
@@ -70,7 +110,7 @@ int main(int argc, char *argv[])
     }
 
     if (argc == 1 || argc > 3) {
-        fprintf(stderr, "usage: %s [-l] file1 [file2]\n", argv[0]);
+        fprintf(stderr, "usage: %s [-l] [-s] file1 [file2]\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
@@ -85,10 +125,19 @@ int main(int argc, char *argv[])
     words = 0;
     unique = createSet(MAX_SIZE, strcmp, strhash);
 
-    while (fscanf(fp, "%s", buffer) == 1) {
-        words ++;
-	if (!findElement(unique, buffer))
-	    addElement(unique, strdup(buffer));
+    while ((n = readBlock(fp, block)) > 0) {
+	words += n;
+	findElements(unique, (void **) block, n, found);
+
+	for (i = 0, m = 0; i < n; i ++)
+	    if (found[i] == NULL)
+		copies[m ++] = strdup(block[i]);
+
+	addElements(unique, (void **) copies, m, found);
+
+	for (i = 0; i < m; i ++)
+	    if (found[i] != copies[i])
+		free(copies[i]);
     }
 
     fclose(fp);
@@ -110,11 +159,15 @@ int main(int argc, char *argv[])
 
         /* Delete all words in the second file. */
 
-        while (fscanf(fp, "%s", buffer) == 1) {
-	    if ((word = findElement(unique, buffer)) != NULL) {
-		removeElement(unique, buffer);
-		free(word);
-	    }
+        while ((n = readBlock(fp, block)) > 0) {
+	    findElements(unique, (void **) block, n, found);
+
+	    for (i = 0; i < n; i ++)
+		if (found[i] != NULL &&
+			(word = findElement(unique, block[i])) != NULL) {
+		    removeElement(unique, block[i]);
+		    free(word);
+		}
 	}
 
 	fclose(fp);
@@ -135,6 +188,11 @@ int main(int argc, char *argv[])
 	free(elts);
     }
 
+    if (sflag) {
+	getSetStats(unique, &stats);
+	printStats(&stats);
+    }
+
     destroySet(unique);
     exit(EXIT_SUCCESS);
 }